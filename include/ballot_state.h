@@ -0,0 +1,145 @@
+#ifndef BALLOT_STATE_H
+#define BALLOT_STATE_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 单个投票人在单个话题中的已投选项 ====================
+
+/**
+ * 投票人已投选项集合
+ * 以选项在话题 options 中的下标（而不是选项ID）记录：下标小于64的选项存放在内联的64位位图中，
+ * 更大的下标（选项超过64个的话题）存放在按需分配的有序数组中。
+ * 常见话题（选项不超过64个）每个投票人只占8字节位图，已投票数为一次 popcount。
+ */
+class BallotState {
+public:
+    static const size_t kInlineOptions = 64;
+
+    BallotState() : bits(0) {}
+    // 由内联位图构造（快照载入时使用）
+    explicit BallotState(uint64_t inlineBits) : bits(inlineBits) {}
+
+    BallotState(const BallotState &other)
+        : bits(other.bits),
+          large(other.large ? new std::vector<uint32_t>(*other.large) : nullptr) {}
+
+    BallotState& operator=(const BallotState &other) {
+        if (this != &other) {
+            bits = other.bits;
+            large.reset(other.large ? new std::vector<uint32_t>(*other.large) : nullptr);
+        }
+        return *this;
+    }
+
+    BallotState(BallotState &&other) noexcept : bits(other.bits), large(std::move(other.large)) {
+        other.bits = 0;
+    }
+
+    BallotState& operator=(BallotState &&other) noexcept {
+        bits = other.bits;
+        large = std::move(other.large);
+        other.bits = 0;
+        return *this;
+    }
+
+    bool contains(size_t slot) const {
+        if (slot < kInlineOptions) {
+            return (bits >> slot) & 1u;
+        }
+        return large && std::binary_search(large->begin(), large->end(), static_cast<uint32_t>(slot));
+    }
+
+    /**
+     * 记录已投选项
+     * @return true表示新增，false表示已存在
+     */
+    bool insert(size_t slot) {
+        if (slot < kInlineOptions) {
+            uint64_t bit = uint64_t(1) << slot;
+            if (bits & bit) return false;
+            bits |= bit;
+            return true;
+        }
+        if (!large) {
+            large.reset(new std::vector<uint32_t>());
+        }
+        uint32_t value = static_cast<uint32_t>(slot);
+        auto it = std::lower_bound(large->begin(), large->end(), value);
+        if (it != large->end() && *it == value) return false;
+        large->insert(it, value);
+        return true;
+    }
+
+    /**
+     * 移除已投选项
+     * @return true表示移除成功，false表示不存在
+     */
+    bool erase(size_t slot) {
+        if (slot < kInlineOptions) {
+            uint64_t bit = uint64_t(1) << slot;
+            if (!(bits & bit)) return false;
+            bits &= ~bit;
+            return true;
+        }
+        if (!large) return false;
+        uint32_t value = static_cast<uint32_t>(slot);
+        auto it = std::lower_bound(large->begin(), large->end(), value);
+        if (it == large->end() || *it != value) return false;
+        large->erase(it);
+        if (large->empty()) {
+            large.reset();
+        }
+        return true;
+    }
+
+    /**
+     * 已投票数
+     */
+    int count() const {
+        return popcount(bits) + (large ? static_cast<int>(large->size()) : 0);
+    }
+
+    bool empty() const { return bits == 0 && !large; }
+
+    /**
+     * 最大已投下标 + 1（没有已投选项时为0）；须小于话题选项数
+     */
+    size_t slotLimit() const {
+        if (large) {
+            return static_cast<size_t>(large->back()) + 1;
+        }
+        size_t limit = 0;
+        for (uint64_t x = bits; x; x >>= 1) {
+            limit++;
+        }
+        return limit;
+    }
+
+    // 下标 < 64 的选项位图
+    uint64_t inlineBits() const { return bits; }
+    // 下标 >= 64 的选项（有序），没有时为 nullptr
+    const std::vector<uint32_t>* overflowSlots() const { return large.get(); }
+
+private:
+    uint64_t bits;                              // 下标 < 64 的选项
+    std::unique_ptr<std::vector<uint32_t>> large; // 下标 >= 64 的选项（有序），没有时为空指针
+
+    static int popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        int n = 0;
+        while (x) {
+            x &= x - 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+};
+
+#endif // BALLOT_STATE_H
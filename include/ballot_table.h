@@ -0,0 +1,101 @@
+#ifndef BALLOT_TABLE_H
+#define BALLOT_TABLE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "ballot_state.h"
+#include "voter_dictionary.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ==================== (话题, 投票人) -> 已投选项 的扁平哈希表 ====================
+
+/**
+ * 话题投票人状态表
+ * 以 (话题ID, 投票人句柄) 组合成的64位键做一次哈希，开放寻址存放在连续数组中，
+ * 插入不再为每个条目单独分配节点。每16个槽位为一组，每个槽位有1字节控制字节
+ * （空/已删除/哈希值的低7位），查找时用 SSE2 一次比较整组控制字节，只对匹配的槽位比较键；
+ * 不支持 SSE2 的平台逐字节比较。
+ */
+class BallotTable {
+public:
+    BallotTable();
+
+    /**
+     * 查找投票人在话题中的已投选项
+     * @return 指针，尚未投票时返回 nullptr（指针在下一次插入前有效）
+     */
+    BallotState* find(int topicId, VoterHandle voter);
+    const BallotState* find(int topicId, VoterHandle voter) const;
+
+    /**
+     * 查找，不存在时插入空记录
+     * @return 记录的引用（在下一次插入前有效）
+     */
+    BallotState& findOrInsert(int topicId, VoterHandle voter);
+
+    /**
+     * 删除投票人在话题中的记录
+     * @return true表示删除成功
+     */
+    bool erase(int topicId, VoterHandle voter);
+
+    /**
+     * 预留容量：插入 n 条记录前不再扩容
+     */
+    void reserve(size_t n);
+
+    void clear();
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * 遍历全部记录（顺序不定）
+     * @param fn 对每条记录调用 fn(int topicId, VoterHandle voter, const BallotState&)
+     */
+    template <class Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (ctrl[i] >= 0) {
+                fn(static_cast<int>(static_cast<uint32_t>(slots[i].key >> 32)),
+                   static_cast<VoterHandle>(slots[i].key & 0xFFFFFFFFu), slots[i].ballot);
+            }
+        }
+    }
+
+    /**
+     * 快照：原样保存控制字节、键与位图，载入时整块复制，不重新哈希
+     */
+    void saveSnapshot(SnapshotWriter &out) const;
+    /**
+     * 从快照载入（替换现有内容）
+     * @param voterCount 投票人字典的大小，键中的投票人句柄须小于该值
+     * @return true表示成功，false表示数据不一致（此时表为空）
+     */
+    bool loadSnapshot(SnapshotReader &in, size_t voterCount);
+
+private:
+    struct Slot {
+        uint64_t key;
+        BallotState ballot;
+    };
+
+    std::vector<int8_t> ctrl;   // 每槽位一个控制字节
+    std::vector<Slot> slots;
+    size_t count;               // 有效记录数
+    size_t tombstones;          // 已删除标记数
+    size_t groupMask;           // 组数 - 1（组数为2的幂）
+
+    static uint64_t makeKey(int topicId, VoterHandle voter) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(topicId)) << 32) | voter;
+    }
+
+    size_t findSlot(uint64_t key, uint64_t hash) const;
+    size_t findInsertSlot(uint64_t hash) const;
+    void eraseAt(size_t index);
+    void rehash(size_t groupCount);
+};
+
+#endif // BALLOT_TABLE_H
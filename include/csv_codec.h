@@ -0,0 +1,222 @@
+#ifndef CSV_CODEC_H
+#define CSV_CODEC_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "buffered_writer.h"
+
+// ==================== CSV 编解码（RFC 4180） ====================
+
+/**
+ * 记录中的一个字段：指向原始数据，不复制
+ * 引号字段（去掉前导空格后以 '"' 开头）的范围包含引号本身，取值需经 CsvCodec::decode
+ */
+struct CsvField {
+    const char *begin;
+    const char *end;
+    bool quoted;
+};
+
+/**
+ * CSV 读取（RFC 4180）：字段以逗号分隔、记录以 '\n' 结束（行尾的 '\r' 去掉），
+ * 含逗号、引号或换行的字段用双引号括起，字段内的引号写成两个引号。
+ * 按 64 字节一块用 SIMD（SSE2，不支持时逐字节）生成引号、逗号、换行的位掩码，
+ * 引号掩码做前缀异或得到“位于引号内”的掩码（跨块延续），逗号、换行掩码去掉引号内的位即为真正的分隔符，
+ * 之后逐位取出分隔符位置，不再逐字节判断引号状态。
+ * 引号按出现次数的奇偶判定（与 simdjson / simdcsv 相同），因此每块同时检查引号是否符合 RFC 4180：
+ * 开引号前须为逗号、换行、数据开头或引号（转义），闭引号后须为逗号、换行、'\r'、引号或数据末尾。
+ * 旧版导出的文件未加引号，标题、选项中可能有单独的引号（如 他说"好"、"Best" pick、"open）；
+ * 遇到第一处不符合的引号，或数据结束时仍位于引号内，从当前记录起改为逐字节读取：
+ * 字段开头（可有前导空白）的引号只有在其闭引号之后紧跟分隔符、行尾或数据末尾时才开始引号字段（见 quotedFieldEnd），
+ * 否则整个字段按普通字符处理；其余引号也按普通字符处理。
+ */
+class CsvReader {
+public:
+    static const size_t kBlockBytes = 64;   // 每次分类的字节数（位掩码宽度）
+
+    CsvReader(const char *data, size_t size);
+
+    // 是否已改为逐字节的宽松读取（数据中有不符合 RFC 4180 的引号）
+    bool isLenient() const { return lenient; }
+
+    /**
+     * 宽松读取的引号字段判定：从字段开头的引号起，跳过转义的两个引号找到闭引号
+     * @param quote 字段开头的引号
+     * @param end 数据末尾
+     * @return 闭引号之后的位置；闭引号之后不是逗号、换行、'\r' 或数据末尾，或没有闭引号时返回 nullptr
+     *         （该字段按普通字符处理）
+     */
+    static const char* quotedFieldEnd(const char *quote, const char *end);
+
+    /**
+     * 读取下一条记录（空行是只有一个空字段的记录）
+     * @param fields 输出数组，依次写入前 maxFields 个字段，其余字段只计数
+     * @return 记录的字段数（可能大于 maxFields）；0 表示数据已读完
+     */
+    size_t next(CsvField *fields, size_t maxFields);
+
+private:
+    const char *start;
+    const char *end;
+    const char *cursor;
+    const char *blockBase;      // 当前 64 字节块的起点
+    uint64_t pendingCommas;     // 当前块中尚未取出的分隔逗号位
+    uint64_t pendingNewlines;   // 当前块中尚未取出的记录结束位
+    uint64_t insideCarry;       // 上一块结束时位于引号内则为全 1
+    bool lenient;
+
+    void loadBlock(const char *base);
+    bool quotesWellFormed(const char *base, uint64_t quotes, uint64_t inside, uint64_t boundaries) const;
+    // 合法引号字段的开引号之前、闭引号之后可以出现的字符
+    static bool isQuoteBoundary(char c) { return c == ',' || c == '\n' || c == '"'; }
+    size_t nextLenient(CsvField *fields, size_t maxFields);
+    static CsvField makeField(const char *begin, const char *end);
+    static CsvField makeField(const char *begin, const char *end, bool quoted) {
+        CsvField field = {begin, end, quoted};
+        return field;
+    }
+    static unsigned lowestSetBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned i = 0;
+        while (!(mask & 1u)) {
+            mask >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+    // 记录末尾的 '\r'（CRLF 换行）不属于最后一个字段
+    static const char* stripCarriageReturn(const char *begin, const char *end);
+};
+
+// 逐条读取在调用方内联展开，读取状态可留在寄存器中；只有每 64 字节一次的分类不内联
+inline CsvField CsvReader::makeField(const char *begin, const char *end) {
+    const char *p = begin;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    CsvField field = {begin, end, p < end && *p == '"'};
+    return field;
+}
+
+inline const char* CsvReader::stripCarriageReturn(const char *begin, const char *end) {
+    return end > begin && end[-1] == '\r' ? end - 1 : end;
+}
+
+inline size_t CsvReader::next(CsvField *fields, size_t maxFields) {
+    if (lenient) {
+        return nextLenient(fields, maxFields);
+    }
+    if (cursor >= end) {
+        return 0;
+    }
+    size_t count = 0;
+    const char *fieldStart = cursor;
+    for (;;) {
+        if (pendingNewlines == 0) {
+            // 记录在本块内没有结束：取出本块剩余的逗号后读下一块
+            while (pendingCommas != 0) {
+                const char *pos = blockBase + lowestSetBit(pendingCommas);
+                pendingCommas &= pendingCommas - 1;
+                if (count < maxFields) {
+                    fields[count] = makeField(fieldStart, pos);
+                }
+                count++;
+                fieldStart = pos + 1;
+            }
+            const char *nextBase = blockBase + kBlockBytes;
+            if (nextBase >= end && insideCarry != 0) {
+                // 数据结束时引号仍未闭合（旧版文件字段开头的单独引号）：本条记录从头按宽松规则重新读取
+                lenient = true;
+                return nextLenient(fields, maxFields);
+            }
+            if (nextBase >= end) {
+                // 最后一条记录没有换行结尾
+                if (count < maxFields) {
+                    fields[count] = makeField(fieldStart, stripCarriageReturn(fieldStart, end));
+                }
+                cursor = end;
+                return count + 1;
+            }
+            loadBlock(nextBase);
+            if (lenient) {
+                // 本条记录从头按宽松规则重新读取（之前的块已检查过，不受影响）
+                return nextLenient(fields, maxFields);
+            }
+            continue;
+        }
+        // 换行之前的逗号属于本条记录
+        uint64_t newlineBit = pendingNewlines & (0 - pendingNewlines);
+        uint64_t commas = pendingCommas & (newlineBit - 1);
+        pendingCommas &= ~(newlineBit | (newlineBit - 1));
+        pendingNewlines &= pendingNewlines - 1;
+        while (commas != 0) {
+            const char *pos = blockBase + lowestSetBit(commas);
+            commas &= commas - 1;
+            if (count < maxFields) {
+                fields[count] = makeField(fieldStart, pos);
+            }
+            count++;
+            fieldStart = pos + 1;
+        }
+        const char *pos = blockBase + lowestSetBit(newlineBit);
+        if (count < maxFields) {
+            fields[count] = makeField(fieldStart, stripCarriageReturn(fieldStart, pos));
+        }
+        cursor = pos + 1;
+        return count + 1;
+    }
+}
+
+class CsvCodec {
+public:
+    /**
+     * 字段取值：未加引号的字段原样返回；引号字段去掉外层引号，两个引号还原为一个
+     */
+    static void decode(const CsvField &field, std::string &out);
+    static std::string decode(const CsvField &field) {
+        std::string out;
+        decode(field, out);
+        return out;
+    }
+
+    /**
+     * 字段是否需要加引号：含逗号、引号、换行，或首尾为空白（读取时未加引号的字段可能被去掉首尾空白）
+     */
+    static bool needsQuoting(const char *data, size_t size) {
+        if (size == 0) {
+            return false;
+        }
+        if (isBlank(data[0]) || isBlank(data[size - 1])) {
+            return true;
+        }
+        // 查表后按位或累积，循环内没有分支
+        unsigned char special = 0;
+        for (size_t i = 0; i < size; i++) {
+            special |= kSpecialChars[static_cast<unsigned char>(data[i])];
+        }
+        return special != 0;
+    }
+
+    /**
+     * 写出一个字段（按需加引号并转义）
+     */
+    static void writeField(BufferedWriter &out, const std::string &value) {
+        if (!needsQuoting(value.data(), value.size())) {
+            out.write(value);
+            return;
+        }
+        writeQuoted(out, value.data(), value.size());
+    }
+
+private:
+    static const unsigned char kSpecialChars[256];    // 逗号、引号、'\n'、'\r' 为 1
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t'; }
+    static void writeQuoted(BufferedWriter &out, const char *data, size_t size);
+};
+
+#endif // CSV_CODEC_H
@@ -15,6 +15,17 @@
 #include <cctype>
 #include <locale>
 #include <codecvt>
+#include <cstdint>
+#include <memory>
+#include "id_index.h"
+#include "vote_stats.h"
+#include "slot_map.h"
+#include "voter_dictionary.h"
+#include "ballot_table.h"
+#include "topic_vote_log.h"
+#include "vote_journal.h"
+#include "snapshot_file.h"
+#include "name_collation.h"
 
 using namespace std;
 
@@ -36,6 +47,8 @@ struct VoteTopic {
     vector<VoteOption> options;
     time_t createdAt;
     int votesPerVoter;
+    VoteCountStats stats;   // 选项得票的总数/最高/最低/过半领先者，由 ElectionSystem 增量维护
+    AdaptiveIdIndex optionIndex; // 选项ID -> options 下标（选项ID紧凑时为数组），创建/导入时由 ElectionSystem 重建
 
     VoteTopic() : id(0), title(""), description(""), createdAt(0), votesPerVoter(1) {}
 };
@@ -50,6 +63,45 @@ struct TopicVoteRecord {
     TopicVoteRecord(int t, const string &v, int o, time_t ts) : topicId(t), voterId(v), optionId(o), votedAt(ts) {}
 };
 
+/**
+ * 批量投票结果
+ * 由 ElectionSystem::vote 在一次遍历中完成校验与计票后返回
+ */
+struct VoteTallyResult {
+    size_t totalCount;                 // 选票总数
+    size_t validCount;                 // 有效票数
+    size_t invalidCount;               // 无效票数
+    vector<size_t> invalidPositions;   // 无效票在投票向量中的位置（从0开始）
+
+    VoteTallyResult() : totalCount(0), validCount(0), invalidCount(0) {}
+};
+
+/**
+ * 候选人投票历史的保留方式（投票历史用于撤销）
+ */
+enum class VoteHistoryRetention {
+    Full,   // 保留全部选票（默认）
+    Tail,   // 只保留最近的若干张选票，只能撤销这些选票
+    None    // 不保留，无法撤销
+};
+
+/**
+ * 流式优胜者检测结果
+ * 由 ElectionSystem::findWinnerStreaming 在常数内存下对投票文件/流计算
+ */
+struct StreamingWinnerResult {
+    int winnerID;              // 严格过半的优胜者ID，没有则为-1
+    bool verified;             // 是否完成第二遍校验（不可回读的流无法校验）
+    int majorityCandidate;     // Boyer-Moore 第一遍得到的候选ID，没有有效票时为-1
+    long long candidateVotes;  // 第二遍统计的候选ID得票数（未校验时为-1）
+    long long validVotes;      // 有效票数
+    long long invalidVotes;    // 无效票数（不在候选人名单中）
+
+    StreamingWinnerResult()
+        : winnerID(-1), verified(false), majorityCandidate(-1),
+          candidateVotes(-1), validVotes(0), invalidVotes(0) {}
+};
+
 /**
  * 候选人数据结构
  */
@@ -58,6 +110,7 @@ struct Candidate {
     string name;         // 候选人姓名
     string department;  // 所属单位（扩展功能）
     int voteCount;       // 得票数
+    string sortKey;      // 姓名排序键缓存（NameCollation::sortKey），姓名修改时由 ElectionSystem 更新
     
     Candidate() : id(0), name(""), department(""), voteCount(0) {}
     Candidate(int i, const string &n, const string &d = "") 
@@ -137,9 +190,11 @@ public:
      */
     static int validateVoteVector(const vector<int> &votes, 
                                    const vector<int> &validIDs) {
+        // 先建哈希集合，整体 O(n + m)，避免每张选票线性查找
+        unordered_set<int> validSet(validIDs.begin(), validIDs.end());
         int invalidCount = 0;
         for (int vote : votes) {
-            if (!validateVoteID(vote, validIDs)) {
+            if (!validSet.count(vote)) {
                 invalidCount++;
             }
         }
@@ -149,12 +204,52 @@ public:
 
 // ==================== 文件管理模块 ====================
 
+/**
+ * 投票数据流式读取器
+ * 按 FileManager::loadVotes 的 CSV/文本格式规则逐个产出投票ID，只保留当前一行，内存占用为常数
+ */
+class VoteStreamReader {
+public:
+    /**
+     * @param in 输入流
+     * @param textFormat true表示文本格式（空白分隔），false表示CSV格式（每行一个ID，可有表头）
+     */
+    VoteStreamReader(istream &in, bool textFormat);
+
+    /**
+     * 读取下一个投票ID
+     * @param vote 投票ID（输出参数）
+     * @return true表示读到，false表示输入结束
+     */
+    bool next(int &vote);
+
+    /**
+     * 已读取的行数（含表头与空行）
+     */
+    size_t linesRead() const { return lines; }
+
+private:
+    istream &in;
+    bool textFormat;
+    size_t lines;
+    std::string line;
+    size_t tokenPos;            // 文本格式：当前行中下一个token的搜索位置
+};
+
 /**
  * 文件管理类
  * 负责数据的保存和加载
  */
 class FileManager {
 public:
+    /**
+     * 设置导出（save* / export*Data）是否使用 O_DIRECT 绕过页缓存写盘
+     * 适合导出远大于内存的数据、避免挤占页缓存；文件系统不支持或非 Linux 平台时照常写入
+     * @param enabled true表示使用 O_DIRECT，默认 false
+     */
+    static void setDirectOutput(bool enabled);
+    static bool getDirectOutput();
+
     static bool saveTopics(const vector<VoteTopic> &topics,
                            const string &filename = "topics.csv");
 
@@ -168,9 +263,21 @@ public:
     static bool exportTopicsData(const vector<VoteTopic> &topics,
                                 const vector<TopicVoteRecord> &voteHistory,
                                 const string &filename = "topics_data.csv");
+    /**
+     * 导入话题数据：先定位各分段，#VOTES 段按整行切块由多个线程并行解析，结果按文件顺序拼接
+     * @param threadCount 解析线程数，0 表示使用硬件并发数（#VOTES 段较小时只用一个线程）
+     */
     static bool importTopicsData(vector<VoteTopic> &topics,
                                 vector<TopicVoteRecord> &voteHistory,
-                                const string &filename = "topics_data.csv");
+                                const string &filename = "topics_data.csv",
+                                unsigned threadCount = 0);
+    // 流版本：供命令行工具从标准输入/标准输出读写
+    static bool exportTopicsData(const vector<VoteTopic> &topics,
+                                const vector<TopicVoteRecord> &voteHistory,
+                                ostream &out);
+    static bool importTopicsData(vector<VoteTopic> &topics,
+                                vector<TopicVoteRecord> &voteHistory,
+                                istream &in, unsigned threadCount = 0);
 
     static bool exportSingleTopicData(const VoteTopic &topic,
                                      const vector<TopicVoteRecord> &voteHistory,
@@ -218,6 +325,15 @@ public:
     static bool loadVotes(vector<int> &votes, 
                           const string &filename = "votes.csv");
     
+    /**
+     * 从输入流加载投票向量（例如标准输入）
+     * @param votes 投票向量（输出参数）
+     * @param in 输入流
+     * @param textFormat true表示按文本格式（空白分隔）解析，false表示按CSV格式解析
+     * @return true表示成功，false表示失败
+     */
+    static bool loadVotes(vector<int> &votes, istream &in, bool textFormat);
+    
     /**
      * 导出统计报告到文本文件
      * @param candidates 候选人列表
@@ -228,6 +344,17 @@ public:
     static bool exportReport(const vector<Candidate> &candidates, 
                              int winnerID, 
                              const string &filename = "election_report.txt");
+    
+    /**
+     * 导出统计报告（候选人已按得票数降序排列，例如 ElectionSystem::getCandidatesByVotes）
+     * @param ranked 按名次排列的候选人
+     * @param winnerID 优胜者ID
+     * @param filename 文件名
+     * @return true表示成功，false表示失败
+     */
+    static bool exportReport(const vector<const Candidate*> &ranked, 
+                             int winnerID, 
+                             const string &filename = "election_report.txt");
 };
 
 // ==================== 统计模块 ====================
@@ -321,70 +448,30 @@ public:
     }
     
     /**
-     * 按姓名排序候选人（标准字典序升序）
+     * 按姓名排序候选人（英文名在前，中文名按拼音/本地化顺序，同名按编号）
+     * 排序键每个候选人只生成一次并缓存在 sortKey 中，排序为基于键字节的 MSD 基数排序
+     * 时间复杂度：O(键的总字节数)
      * @param candidates 候选人列表（会被修改）
      */
     static void sortByName(vector<Candidate> &candidates) {
-        auto isAsciiEnglishName = [](const string &name) -> bool {
-            if (name.empty()) return false;
-            for (unsigned char c : name) {
-                if (c >= 0x80) return false;
-                if (!(std::isalpha(c) || c == ' ')) {
-                    return false;
-                }
-            }
-            return true;
-        };
-        
-        auto makeAsciiKey = [](const string &name) -> string {
-            string key;
-            key.reserve(name.size());
-            for (unsigned char c : name) {
-                if (c == ' ') continue;
-                key.push_back(static_cast<char>(std::tolower(c)));
-            }
-            return key;
-        };
-        
-        auto makeChineseKey = [](const string &name) -> string {
-            try {
-                // 使用中文本地化规则在 UTF-8 字节序上生成排序键，近似按拼音排序
-                static std::locale zhLoc("zh_CN.UTF-8");
-                const auto &coll = std::use_facet<std::collate<char>>(zhLoc);
-                return coll.transform(name.data(), name.data() + name.size());
-            } catch (...) {
-                // 回退：直接使用原始字节序
-                return name;
+        vector<NameCollation::KeyRef> refs;
+        refs.reserve(candidates.size());
+        for (size_t i = 0; i < candidates.size(); i++) {
+            Candidate &c = candidates[i];
+            if (c.sortKey.empty()) {
+                c.sortKey = NameCollation::sortKey(c.name);
             }
-        };
+            NameCollation::KeyRef ref = {&c.sortKey, c.id, i};
+            refs.push_back(ref);
+        }
+        NameCollation::radixSort(refs);
         
-        sort(candidates.begin(), candidates.end(),
-             [&](const Candidate &a, const Candidate &b) {
-                 bool aEng = isAsciiEnglishName(a.name);
-                 bool bEng = isAsciiEnglishName(b.name);
-                 
-                 // 所有英文名排在中文名之前
-                 if (aEng != bEng) {
-                     return aEng; // true 在前
-                 }
-                 
-                 if (aEng && bEng) {
-                     string ka = makeAsciiKey(a.name);
-                     string kb = makeAsciiKey(b.name);
-                     if (ka == kb) {
-                         return a.id < b.id;
-                     }
-                     return ka < kb;
-                 }
-                 
-                 // 中文（或混合）名：使用本地化排序键
-                 string ka = makeChineseKey(a.name);
-                 string kb = makeChineseKey(b.name);
-                 if (ka == kb) {
-                     return a.id < b.id;
-                 }
-                 return ka < kb;
-             });
+        vector<Candidate> sorted;
+        sorted.reserve(candidates.size());
+        for (const auto &ref : refs) {
+            sorted.push_back(std::move(candidates[ref.index]));
+        }
+        candidates.swap(sorted);
     }
 };
 
@@ -396,51 +483,132 @@ public:
  */
 class ElectionSystem {
 private:
-    vector<Candidate> candidates;           // 候选人列表（使用STL vector）
-    unordered_map<int, int> idToIndex;      // ID到索引的映射（使用STL unordered_map）
-    vector<int> voteHistory;                // 投票历史记录（使用STL vector）
+    SlotMap<Candidate> candidates;          // 候选人列表（槽位表：紧密数组 + 代数句柄，删除 O(1)）
+    AdaptiveIdIndex idToIndex;              // ID到索引的映射（ID紧凑时为数组，稀疏时为哈希表）
+    vector<int> voteHistory;                // 投票历史记录（使用STL vector），按 historyRetention 保留
+    VoteHistoryRetention historyRetention;
+    size_t historyTail;                     // Tail 方式保留的选票数
+
+    SlotMap<VoteTopic> topics;
+    unordered_map<int, int> topicIdToIndex; // 话题ID -> 紧密数组下标
 
-    vector<VoteTopic> topics;
-    unordered_map<int, int> topicIdToIndex;
+    // 投票人ID字典：话题投票状态与历史中的投票人均以句柄表示
+    VoterDictionary voters;
 
-    // topicId -> voterId -> set<optionId> (已投的选项ID集合)，用于支持“每人可投N票且不能重复投同一选项”
-    unordered_map<int, unordered_map<string, unordered_set<int>>> topicVotedUsers;
+    // (topicId, 投票人句柄) -> 已投选项（内联位图），用于支持“每人可投N票且不能重复投同一选项”
+    BallotTable topicBallots;
 
     int nextTopicId;
 
-    // 话题投票历史（用于管理员撤销最近一次前端投票）
-    vector<TopicVoteRecord> topicVoteHistory;
+    // 话题投票历史，按话题分区（用于导出与撤销）；记录带全局序号以恢复跨话题的投票顺序
+    unordered_map<int, TopicVoteLog> topicHistories;
+    uint64_t nextVoteSequence;
+    bool historyCompression;                // 新建的话题历史沿用的压缩设置
+    size_t historyUndoWindow;
 
-    void updateTopicIndexMap() {
-        topicIdToIndex.clear();
-        for (size_t i = 0; i < topics.size(); i++) {
-            topicIdToIndex[topics[i].id] = i;
-        }
-    }
+    // 候选人得票统计（总票数/最高/最低/过半领先者），随投票、撤销、重置增量更新
+    VoteCountStats candidateStats;
+
+    // 话题投票预写日志（未打开时为空）；journalRecord 为复用的编码缓冲区
+    std::unique_ptr<VoteJournal> journal;
+    JournalEncoder journalRecord;
+    string journalPath;                     // 打开日志时的路径与参数（压缩时重新打开）
+    VoteJournal::Options journalOptions;
+    uint64_t journalSkipped;                // 上次重放时跳过的无法应用的记录数
 
     /**
      * 更新ID到索引的映射
      */
     void updateIndexMap() {
-        idToIndex.clear();
-        for (size_t i = 0; i < candidates.size(); i++) {
-            idToIndex[candidates[i].id] = i;
+        vector<int> ids;
+        ids.reserve(candidates.size());
+        for (const auto &c : candidates) {
+            ids.push_back(c.id);
         }
+        idToIndex.rebuild(ids);
     }
-    
-    /**
-     * 获取有效的候选人ID列表
-     * @return 有效的候选人ID列表
-     */
-    vector<int> getValidIDs() const {
-        vector<int> validIDs;
-        for (const auto &c : candidates) {
-            validIDs.push_back(c.id);
+
+    void rebuildCandidateStats() {
+        candidateStats.rebuild(candidates,
+                               [](const Candidate &c) { return c.id; },
+                               [](const Candidate &c) { return c.voteCount; });
+    }
+
+    // 按选项ID查找选项，O(1)（经 VoteTopic::optionIndex）
+    static VoteOption* findOption(VoteTopic &topic, int optionId) {
+        int index = topic.optionIndex.find(optionId);
+        return index == AdaptiveIdIndex::npos ? nullptr : &topic.options[index];
+    }
+    static const VoteOption* findOption(const VoteTopic &topic, int optionId) {
+        int index = topic.optionIndex.find(optionId);
+        return index == AdaptiveIdIndex::npos ? nullptr : &topic.options[index];
+    }
+
+    // 按 createTopic 的规则校验并填充话题（不分配ID）
+    static bool buildTopic(const string &title, const string &description,
+                           const vector<string> &optionTexts, int votesPerVoter, VoteTopic &topic);
+
+    // 重建话题的选项索引与得票统计（创建、导入话题时调用）
+    static void rebuildTopicStats(VoteTopic &topic) {
+        vector<int> optionIds;
+        optionIds.reserve(topic.options.size());
+        for (const auto &opt : topic.options) {
+            optionIds.push_back(opt.id);
         }
-        return validIDs;
+        topic.optionIndex.rebuild(optionIds);
+        topic.stats.rebuild(topic.options,
+                            [](const VoteOption &o) { return o.id; },
+                            [](const VoteOption &o) { return o.voteCount; });
+    }
+
+    // 话题的投票历史，不存在时按当前压缩设置创建
+    TopicVoteLog& topicHistory(int topicId);
+    // 追加一条话题投票记录，分配全局序号
+    void appendTopicVote(int topicId, VoterHandle voter, int optionId, time_t votedAt) {
+        topicHistory(topicId).append(TopicVoteEntry(topicId, voter, optionId, votedAt, nextVoteSequence++));
     }
+    // 撤销已从历史中弹出的一条记录：减票并移除投票人的该选项
+    void revokeTopicVote(const TopicVoteEntry &rec);
+    // 以指定投票时间投票（castTopicVote 与日志重放共用）
+    bool castTopicVoteAt(int topicId, int optionId, VoterHandle voter, time_t votedAt);
+    // 恢复一条导入的投票记录：写入历史与投票人限制，不计票；投票人ID与在线投票一样去掉首尾空白，空ID忽略
+    void restoreTopicVote(int topicId, const AdaptiveIdIndex &optionIndex,
+                          const string &voterId, int optionId, time_t votedAt);
+    // 清空话题、投票人与话题投票历史（保留候选人与压缩设置）
+    void clearTopicState();
+
+    // 写入日志（仅在日志打开时调用）
+    void journalTopic(const VoteTopic &topic);
+    void journalTopicEvent(JournalEvent event, int topicId, int optionId = 0);
+    void journalVote(JournalEvent event, int topicId, int optionId, time_t votedAt, const string &voterId);
+    // 重放一条日志记录（与原操作相同，原操作失败的记录不会写入日志），记录格式错误时返回 false
+    bool applyJournalRecord(JournalDecoder &in);
+    // 把当前全部话题状态写入日志（清空 + 话题 + 投票记录）
+    void journalAllTopics();
+    // 关闭已打开的日志并清空话题数据，然后重放日志文件（只读）；validLength 输出有效数据长度
+    bool replayJournalFile(const string &path, uint64_t *validLength);
+    
+    // 批量计票辅助：计数数组长度（稠密索引为ID范围，稀疏索引为候选人数）
+    size_t tallyCountSlots() const;
+    // 对 votes[begin, end) 计票到 counts，无效票位置追加到 invalidPositions；只读，可多线程并发调用
+    void tallyChunk(const int *votes, size_t begin, size_t end,
+                    uint64_t *counts, vector<size_t> &invalidPositions) const;
+    // 把计数合并到候选人得票数（超出 int 范围时饱和在 INT_MAX）；返回是否有落在ID范围内但不存在的选票
+    bool applyTallyCounts(const uint64_t *counts);
+    void collectInvalidPositions(const int *votes, size_t count, vector<size_t> &positions) const;
+    // 对一批选票计票（在现有基础上累加），无效票位置（批内下标）写入 invalidPositions；不更新统计与历史
+    void tallyBatch(const int *votes, size_t count, vector<size_t> &invalidPositions);
+    // 按保留方式追加投票历史
+    void recordVoteHistory(const int *votes, size_t count);
     
 public:
+    /**
+     * 候选人/话题句柄：插入、删除其他对象后仍然有效；对象被删除或清空后失效，
+     * 此时按句柄查询返回 nullptr。需要跨操作持有对象时使用句柄而不是指针。
+     */
+    typedef SlotHandle CandidateHandle;
+    typedef SlotHandle TopicHandle;
+
     /**
      * 构造函数
      */
@@ -448,11 +616,17 @@ public:
         candidates.clear();
         idToIndex.clear();
         voteHistory.clear();
+        historyRetention = VoteHistoryRetention::Full;
+        historyTail = 0;
         topics.clear();
         topicIdToIndex.clear();
-        topicVotedUsers.clear();
-        topicVoteHistory.clear();
+        topicBallots.clear();
+        topicHistories.clear();
+        nextVoteSequence = 0;
+        historyCompression = false;
+        historyUndoWindow = TopicVoteLog::kDefaultUndoWindow;
         nextTopicId = 1;
+        journalSkipped = 0;
     }
     
     /**
@@ -464,6 +638,16 @@ public:
      */
     bool addCandidate(int id, const string &name, const string &department = "");
     
+    /**
+     * 批量添加候选人（例如 FileManager::loadCandidates 的结果）
+     * 一次预留容量，逐行做与 addCandidate 相同的校验，索引增量建立，整体 O(n)；
+     * 与 addCandidate 一样新候选人票数为0，重复ID只保留第一条
+     * @param rows 候选人行
+     * @param rejectedRows 若非空，追加被拒绝的行号（从0开始）
+     * @return 成功添加的数量
+     */
+    size_t addCandidates(const vector<Candidate> &rows, vector<size_t> *rejectedRows = nullptr);
+    
     /**
      * 修改候选人信息
      * @param id 候选人编号
@@ -486,27 +670,101 @@ public:
      * @return 候选人指针，如果不存在返回nullptr
      */
     Candidate* queryCandidate(int id) {
-        if (!idToIndex.count(id)) {
+        int index = idToIndex.find(id);
+        if (index == AdaptiveIdIndex::npos) {
             return nullptr;
         }
-        return &candidates[idToIndex[id]];
+        return &candidates[index];
     }
     
     /**
-     * 获取所有候选人
-     * @return 候选人列表的常量引用
+     * 获取候选人句柄
+     * @param id 候选人编号
+     * @return 句柄，不存在时返回空句柄（isNull()）
      */
-    const vector<Candidate>& getAllCandidates() const {
-        return candidates;
+    CandidateHandle getCandidateHandle(int id) const {
+        int index = idToIndex.find(id);
+        if (index == AdaptiveIdIndex::npos) {
+            return CandidateHandle();
+        }
+        return candidates.handleAt(index);
+    }
+    
+    /**
+     * 按句柄查询候选人
+     * @param handle 候选人句柄
+     * @return 候选人指针，候选人已被删除（句柄失效）时返回nullptr
+     */
+    Candidate* queryCandidate(CandidateHandle handle) {
+        return candidates.get(handle);
+    }
+    const Candidate* queryCandidate(CandidateHandle handle) const {
+        return candidates.get(handle);
+    }
+    
+    /**
+     * 获取所有候选人（按添加顺序；删除不改变其余候选人的顺序）
+     * 删除过候选人时按插入序号排序后复制，O(n log n)，否则直接复制，O(n)
+     * @return 候选人列表的副本
+     */
+    vector<Candidate> getAllCandidates() const {
+        return candidates.ordered();
     }
     
     /**
      * 投票（使用选举向量v）
+     * 校验与计票在同一次遍历中完成，每张选票只做一次索引查找
      * 时间复杂度：O(m)，其中m是投票向量的长度
      * 空间复杂度：O(m)
      * @param votes 选举向量v，长度为m，每个元素是候选人ID
+     * @return 计票结果（有效/无效票数及无效票位置）
+     */
+    VoteTallyResult vote(const vector<int> &votes, bool resetExisting = true);
+    
+    /**
+     * 多线程批量投票
+     * 投票向量按线程数切分，每个线程在私有（按缓存行填充的）计数数组上计票，最后合并到候选人；
+     * 投票历史保持原始顺序，结果与 vote() 完全一致。批量较小时退回单线程。
+     * @param votes 选举向量
+     * @param threadCount 线程数，0 表示使用硬件并发数
+     * @return 计票结果
+     */
+    VoteTallyResult voteParallel(const vector<int> &votes, unsigned threadCount = 0);
+
+    // 流式导入时每次读取的块大小
+    static const size_t kImportChunkBytes = 4u << 20;
+
+    /**
+     * 流式导入投票文件（边读边计票）
+     * 后台线程按 chunkBytes 分块预读，当前块解析出的选票按批直接计入候选人得票数，不生成完整的投票向量；
+     * 内存占用为两个块缓冲区、一个计票批次与按保留方式保存的投票历史，与文件大小无关。
+     * 计票结果与 loadVotes + vote 相同；invalidPositions 只记录前 kMaxReportedInvalid 个无效票位置。
+     * @param filename 投票文件（扩展名为 txt 时按文本格式解析）
+     * @param result 计票结果（输出参数）
+     * @param chunkBytes 块大小
+     * @return true表示成功，false表示文件无法打开或CSV文件为空（此时不计票）
+     */
+    bool importVotes(const string &filename, VoteTallyResult &result, size_t chunkBytes = kImportChunkBytes);
+
+    /**
+     * 流式导入投票（输入流版本，例如标准输入）
+     * @param in 投票数据流
+     * @param textFormat true表示文本格式，false表示CSV格式
+     */
+    bool importVotes(istream &in, bool textFormat, VoteTallyResult &result, size_t chunkBytes = kImportChunkBytes);
+
+    // 流式导入时记录的无效票位置上限
+    static const size_t kMaxReportedInvalid = 1024;
+
+    /**
+     * 设置投票历史的保留方式
+     * Full 保留全部选票；Tail 只保留最近 tailWindow 张（内存不超过 2 × tailWindow）；None 不保留。
+     * 切换时立即按新方式裁剪已有历史。
+     * @param retention 保留方式
+     * @param tailWindow Tail 方式下可撤销的选票数
      */
-    void vote(const vector<int> &votes, bool resetExisting = true);
+    void setVoteHistoryRetention(VoteHistoryRetention retention, size_t tailWindow = 0);
+    VoteHistoryRetention getVoteHistoryRetention() const { return historyRetention; }
     
     /**
      * 单票投票
@@ -517,14 +775,88 @@ public:
     
     /**
      * 查找优胜者（超过半数选票的候选人）
-     * 时间复杂度：O(n)，其中n是候选人数量
-     * 空间复杂度：O(1)
+     * 时间复杂度：O(1)，排名随每次投票/撤销增量维护，只需检查第一名
      * @return 优胜者ID，如果没有超过半数的候选人则返回-1
      */
-    int findWinner();
+    int findWinner() const;
+    
+    /**
+     * 候选人总票数（增量维护，O(1)），流式导入的票数可能超过 int 范围
+     */
+    long long getTotalVotes() const {
+        return candidateStats.total();
+    }
+    
+    /**
+     * 候选人平均得票数（O(1)）
+     */
+    double getAverageVotes() const {
+        if (candidates.empty()) return 0.0;
+        return static_cast<double>(candidateStats.total()) / candidates.size();
+    }
+    
+    /**
+     * 候选人最高得票数（O(1)），没有候选人时为0
+     */
+    int getMaxVotes() const {
+        return candidateStats.maxCount();
+    }
+    
+    /**
+     * 候选人最低得票数（O(1)），没有候选人时为0
+     */
+    int getMinVotes() const {
+        return candidateStats.minCount();
+    }
+    
+    /**
+     * 按得票数降序返回前K名候选人，无需排序
+     * 时间复杂度：O(K)
+     * @param k 数量，0 表示全部
+     * @return 候选人指针列表（候选人增删后失效）
+     */
+    vector<const Candidate*> getCandidatesByVotes(size_t k = 0) const;
+    
+    /**
+     * 候选人名次（从1开始，同票同名次），O(1)
+     * @param id 候选人编号
+     * @return 名次，候选人不存在时返回0
+     */
+    int getCandidateRank(int id) const {
+        return static_cast<int>(candidateStats.ranking().rankOf(id));
+    }
+    
+    /**
+     * 候选人与第一名相差的票数，O(1)
+     * @param id 候选人编号
+     * @return 票数差，候选人不存在时返回-1
+     */
+    int getVotesBehindLeader(int id) const {
+        return candidateStats.ranking().votesBehindLeader(id);
+    }
+    
+    /**
+     * 流式查找优胜者（不把投票载入内存）
+     * 第一遍用 Boyer-Moore 多数投票算法得到唯一可能过半的候选ID，第二遍校验其是否严格过半，
+     * 语义与 findWinner 相同（只统计名单内的有效票）；内存占用与投票数量无关。
+     * 已有候选人名单时按名单校验选票；名单为空时所有ID都视为有效。
+     * 不可回读的流（如管道）只能完成第一遍，结果标记为未校验。
+     * @param in 投票数据流
+     * @param textFormat true表示文本格式，false表示CSV格式
+     * @return 检测结果
+     */
+    StreamingWinnerResult findWinnerStreaming(istream &in, bool textFormat) const;
     
     /**
-     * 获取投票历史
+     * 流式查找优胜者（文件版本，始终完成校验）
+     * @param filename 投票文件（扩展名为 txt 时按文本格式解析）
+     * @param result 检测结果（输出参数）
+     * @return true表示成功，false表示文件无法打开
+     */
+    bool findWinnerStreaming(const string &filename, StreamingWinnerResult &result) const;
+    
+    /**
+     * 获取投票历史（按保留方式保留的部分）
      * @return 投票历史向量
      */
     const vector<int>& getVoteHistory() const {
@@ -532,7 +864,7 @@ public:
     }
     
     /**
-     * 撤销最近一次投票
+     * 撤销最近一次投票（只能撤销保留在投票历史中的选票）
      * @return true 撤销成功，false 无投票可撤销
      */
     bool undoLastVote();
@@ -551,11 +883,11 @@ public:
         candidates.clear();
         idToIndex.clear();
         voteHistory.clear();
-        topics.clear();
-        topicIdToIndex.clear();
-        topicVotedUsers.clear();
-        topicVoteHistory.clear();
-        nextTopicId = 1;
+        clearTopicState();
+        candidateStats.clear();
+        if (journal) {
+            journalTopicEvent(JournalEvent::Clear, 0);
+        }
     }
     
     /**
@@ -566,22 +898,167 @@ public:
             c.voteCount = 0;
         }
         voteHistory.clear();
+        rebuildCandidateStats();
     }
 
     int createTopic(const string &title, const string &description, const vector<string> &optionTexts, int votesPerVoter = 1);
+    /**
+     * 批量创建话题：每个 spec 取标题、描述、选项文本与每人票数，校验规则同 createTopic
+     * @param specs 话题描述（id、票数、创建时间被忽略）
+     * @param createdIds 若非空，按顺序追加每个 spec 的新话题ID（失败为-1）
+     * @return 成功创建的数量
+     */
+    size_t createTopics(const vector<VoteTopic> &specs, vector<int> *createdIds = nullptr);
     bool deleteTopic(int topicId);
     VoteTopic* queryTopic(int topicId);
-    const vector<VoteTopic>& getAllTopics() const {
-        return topics;
+    // 话题句柄，不存在时返回空句柄；按句柄查询在话题被删除后返回 nullptr
+    TopicHandle getTopicHandle(int topicId) const;
+    VoteTopic* queryTopic(TopicHandle handle) {
+        return topics.get(handle);
+    }
+    const VoteTopic* queryTopic(TopicHandle handle) const {
+        return topics.get(handle);
+    }
+    // 获取所有话题（按添加顺序，规则同 getAllCandidates）
+    vector<VoteTopic> getAllTopics() const {
+        return topics.ordered();
     }
 
     bool castTopicVote(int topicId, int optionId);
     // 带投票人ID的投票，确保每个投票人在同一话题仅能投一次
     bool castTopicVote(int topicId, int optionId, const string &voterId);
+    // 按投票人句柄投票：同一投票人多次投票时省去ID的去空白与哈希
+    bool castTopicVote(int topicId, int optionId, VoterHandle voter);
     int getTopicRemainingVotes(int topicId, const string &voterId) const;
-    int getTopicTotalVotes(int topicId) const;
+    int getTopicRemainingVotes(int topicId, VoterHandle voter) const;
+
+    /**
+     * 登记投票人ID并返回句柄（去除首尾空白；已登记时返回原句柄）
+     * 句柄在 clearAll / loadTopicsData 之前保持有效
+     * @param voterId 投票人ID
+     * @return 句柄，ID为空时返回 VoterDictionary::kNoVoter
+     */
+    VoterHandle internVoter(const string &voterId);
+    // 查找已登记的投票人，未登记时返回 VoterDictionary::kNoVoter
+    VoterHandle findVoter(const string &voterId) const;
+    /**
+     * 按预计规模预留投票人字典与投票人状态表，投票过程中不再扩容
+     * @param expectedVoters 预计投票人数
+     * @param expectedBallots 预计 (话题, 投票人) 组合数，为0时按投票人数
+     */
+    void reserveVoters(size_t expectedVoters, size_t expectedBallots = 0) {
+        voters.reserve(expectedVoters);
+        topicBallots.reserve(expectedBallots > 0 ? expectedBallots : expectedVoters);
+    }
+    const VoterDictionary& getVoterDictionary() const { return voters; }
+    // 话题总票数/最高票数（增量维护，O(1)）
+    long long getTopicTotalVotes(int topicId) const;
+    int getTopicMaxVotes(int topicId) const;
+    // 话题中得票严格过半的选项ID，没有则返回-1
+    int getTopicWinner(int topicId) const;
+    // 按得票数降序返回话题前K个选项（k 为0表示全部），O(K)，无需排序
+    vector<const VoteOption*> getTopicOptionsByVotes(int topicId, size_t k = 0) const;
+    // 选项名次（从1开始，同票同名次），话题或选项不存在时返回0
+    int getTopicOptionRank(int topicId, int optionId) const;
+    // 撤销全局最近一次投票（比较各话题最后一条记录的序号，O(话题数)）
     bool undoLastTopicVote(TopicVoteRecord *undone = nullptr);
-    const vector<TopicVoteRecord>& getTopicVoteHistory() const { return topicVoteHistory; }
+    /**
+     * 撤销指定话题最近一次投票，不影响其他话题
+     * @param topicId 话题ID
+     * @param undone 若非空，写入被撤销的记录
+     * @return true表示撤销成功，false表示话题不存在或没有投票记录
+     */
+    bool undoLastTopicVote(int topicId, TopicVoteRecord *undone);
+    // 全部投票历史（按全局序号归并各话题，投票人ID由字典还原），O(m log k)，k 为话题数；导出等需要字符串ID时使用
+    vector<TopicVoteRecord> getTopicVoteHistory() const;
+    // 单个话题的投票历史（按投票顺序），O(该话题票数)
+    vector<TopicVoteRecord> getTopicVoteHistory(int topicId) const;
+    // 投票历史总条数，O(话题数)
+    size_t getTopicVoteCount() const;
+    // 单个话题的内部记录（列式存储，投票人为句柄），不复制；没有投票记录时返回 nullptr
+    const TopicVoteLog* getTopicVoteLog(int topicId) const;
+    /**
+     * 设置话题投票历史的旧块压缩（见 TopicVoteLog），对已有与之后创建的话题历史均生效
+     * @param enabled 是否压缩
+     * @param undoWindow 每个话题最近的多少条记录保持不压缩
+     */
+    void setTopicHistoryCompression(bool enabled, size_t undoWindow = TopicVoteLog::kDefaultUndoWindow);
+
+    /**
+     * 整体载入话题数据（替换现有全部话题）
+     * 选项票数以导入数据为准，投票人限制根据投票记录重建
+     * @param importedTopics 话题列表（通常来自 FileManager::importTopicsData）
+     * @param importedHistory 投票记录
+     * @return true表示成功，false表示数据为空
+     */
+    bool loadTopicsData(const vector<VoteTopic> &importedTopics,
+                        const vector<TopicVoteRecord> &importedHistory);
+
+    /**
+     * 以指定ID追加导入单个话题（保留现有话题）
+     * 选项票数与创建时间以导入数据为准，投票记录改写为新ID后追加到历史并重建投票人限制
+     * @param importedTopic 话题（通常来自 FileManager::importSingleTopicData）
+     * @param importedHistory 该话题的投票记录
+     * @param newTopicId 导入后的话题ID
+     * @return true表示成功，false表示ID非法/已存在或话题数据无效
+     */
+    bool importTopic(const VoteTopic &importedTopic,
+                     const vector<TopicVoteRecord> &importedHistory,
+                     int newTopicId);
+
+    /**
+     * 打开话题投票日志
+     * 先重放已有日志，重建话题、投票人限制与投票历史（替换现有话题数据，候选人不受影响），
+     * 之后的话题创建/删除、投票、撤销、导入都追加到日志，由后台线程按组提交落盘。
+     * 日志末尾崩溃时写了一半的记录被丢弃；校验通过但无法应用的记录被跳过（见 getJournalSkippedRecords）。
+     * @param path 日志文件路径，不存在时新建
+     * @param options 组提交参数（提交间隔、记录数阈值、是否 fsync）
+     * @return true表示成功，false表示文件无法读写或不是投票日志
+     */
+    bool openJournal(const string &path, const VoteJournal::Options &options = VoteJournal::Options());
+    /**
+     * 只读重放话题投票日志：重建话题数据（规则同 openJournal），但不打开日志写入，也不截断文件
+     * 已打开的日志先被关闭；用于导出、检查等不应修改日志文件的场合
+     * @param path 日志文件路径
+     * @return true表示成功（文件不存在时为空数据），false表示文件无法读取或不是投票日志
+     */
+    bool replayJournal(const string &path);
+    /**
+     * 等待已写入日志的记录全部提交
+     * @return true表示未打开日志或提交成功
+     */
+    bool syncJournal();
+    // 提交剩余记录并关闭日志
+    void closeJournal();
+    bool isJournaling() const { return journal != nullptr; }
+    /**
+     * 压缩日志：把当前话题状态（清空 + 话题 + 投票记录）写入新文件，落盘后替换原日志并继续追加
+     * 日志只追加，长期运行会不断增长；可在启动重放后、退出前或载入快照后调用
+     * @return true表示未打开日志或压缩成功；false表示失败（替换前失败时原日志保持不变并继续使用）
+     */
+    bool compactJournal();
+    // 日志是否发生过写入错误（此后的操作不再写入日志）
+    bool journalFailed() const { return journal && journal->failed(); }
+    // 上次 openJournal 重放时跳过的记录数
+    uint64_t getJournalSkippedRecords() const { return journalSkipped; }
+
+    /**
+     * 保存话题状态的二进制快照：话题与选项票数、投票人字典、投票人限制表与各话题投票历史
+     * 先写临时文件再重命名，失败时不影响已有快照
+     * @param path 快照文件路径
+     * @return true表示成功
+     */
+    bool saveSnapshot(const string &path) const;
+    /**
+     * 载入快照（替换现有话题数据，候选人不受影响）
+     * 文件映射到内存后各段整块复制到对应容器，不做文本解析；投票人句柄与保存时相同，
+     * 载入前取得的话题句柄全部失效；日志打开时把日志压缩为载入后的状态（见 compactJournal）
+     * @param path 快照文件路径
+     * @param verifyChecksum 是否校验正文校验和；不校验时仍检查各段的边界、块布局、投票人句柄，
+     *        以及投票人记录的话题与选项下标、下一个话题ID的范围
+     * @return true表示成功，false表示文件无效（此时现有数据不变）
+     */
+    bool loadSnapshot(const string &path, bool verifyChecksum = true);
 };
 
 #endif // ELECTION_CORE_H
@@ -119,6 +119,9 @@ private slots:
     // 表格选择变化
     void onCandidateTableSelectionChanged();
 
+    // 定时检查话题投票日志是否发生写入错误
+    void checkJournalStatus();
+
 
     // 更新图表
     void updateCharts();
@@ -168,6 +171,9 @@ private:
     void updateVoterTopicOptionTable();
     void showTopicResultDialog(int topicId);
     void updateTopicTable();
+    // 话题投票日志：压缩（重放有跳过记录时不压缩，以免丢弃这些记录）与错误提示（只提示一次）
+    void compactTopicJournal();
+    void reportJournalError(const QString &message);
 
     // 核心系统
     ElectionSystem *electionSystem;
@@ -266,6 +272,10 @@ private:
     // 字体缩放
     int baseFontPointSize;
     int currentFontDelta;
+
+    // 话题投票日志路径；写入错误是否已提示
+    QString journalPath;
+    bool journalErrorReported;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,188 @@
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+
+// ==================== 自适应 ID 索引 ====================
+
+/**
+ * ID 到下标的自适应索引
+ * ID 范围紧凑时（如 1..N）使用直接下标数组，查找只需一次减法与一次比较；
+ * ID 稀疏时退回哈希表。重建时自动选择表示方式，增量插入时若数组会变得过于稀疏则转换为哈希表。
+ */
+class AdaptiveIdIndex {
+public:
+    enum : int { npos = -1 };   // 不存在时的返回值
+
+    AdaptiveIdIndex() : dense(true), base(0), count(0) {}
+
+    /**
+     * 查找ID对应的下标
+     * @param id 编号
+     * @return 下标，不存在时返回 npos
+     */
+    int find(int id) const {
+        if (dense) {
+            size_t offset = static_cast<size_t>(static_cast<unsigned int>(id) - static_cast<unsigned int>(base));
+            return offset < slots.size() ? slots[offset] : npos;
+        }
+        auto it = hashed.find(id);
+        return it == hashed.end() ? npos : it->second;
+    }
+
+    bool contains(int id) const {
+        return find(id) != npos;
+    }
+
+    /**
+     * 插入或覆盖ID对应的下标
+     * @param id 编号
+     * @param index 下标（非负）
+     */
+    void insert(int id, int index) {
+        if (!dense) {
+            auto result = hashed.insert(std::make_pair(id, index));
+            if (result.second) {
+                count++;
+            } else {
+                result.first->second = index;
+            }
+            return;
+        }
+
+        if (slots.empty()) {
+            base = id;
+            slots.assign(1, npos);
+        } else if (id < base || static_cast<long long>(id) - base >= static_cast<long long>(slots.size())) {
+            long long newBase = std::min<long long>(base, id);
+            long long newEnd = std::max<long long>(static_cast<long long>(base) + slots.size(), static_cast<long long>(id) + 1);
+            if (!isCompact(newEnd - newBase, count + 1)) {
+                convertToHash();
+                insert(id, index);
+                return;
+            }
+            if (newBase == base) {
+                // 向高端扩展时按倍数预留，逐个追加递增ID时摊还 O(1)
+                long long reserved = std::max<long long>(newEnd - newBase, static_cast<long long>(slots.size()) * 2);
+                reserved = std::min<long long>(reserved, static_cast<long long>(INT_MAX) - newBase + 1);
+                if (isCompact(reserved, count + 1)) {
+                    newEnd = newBase + reserved;
+                }
+            }
+            growTo(static_cast<int>(newBase), static_cast<size_t>(newEnd - newBase));
+        }
+
+        int &slot = slots[static_cast<size_t>(id - base)];
+        if (slot == npos) {
+            count++;
+        }
+        slot = index;
+    }
+
+    /**
+     * 删除ID
+     * @param id 编号
+     * @return true表示删除成功，false表示ID不存在
+     */
+    bool erase(int id) {
+        if (!dense) {
+            if (hashed.erase(id)) {
+                count--;
+                return true;
+            }
+            return false;
+        }
+        size_t offset = static_cast<size_t>(static_cast<unsigned int>(id) - static_cast<unsigned int>(base));
+        if (offset >= slots.size() || slots[offset] == npos) {
+            return false;
+        }
+        slots[offset] = npos;
+        count--;
+        return true;
+    }
+
+    void clear() {
+        slots.clear();
+        hashed.clear();
+        dense = true;
+        base = 0;
+        count = 0;
+    }
+
+    /**
+     * 按下标顺序重建索引：ids[i] 映射到 i（ID重复时保留第一次出现的下标）
+     * 根据ID范围是否紧凑选择数组或哈希表
+     * @param ids 各下标对应的ID
+     */
+    void rebuild(const std::vector<int> &ids) {
+        clear();
+        if (ids.empty()) {
+            return;
+        }
+        auto range = std::minmax_element(ids.begin(), ids.end());
+        long long span = static_cast<long long>(*range.second) - *range.first + 1;
+        if (isCompact(span, ids.size())) {
+            base = *range.first;
+            slots.assign(static_cast<size_t>(span), npos);
+            for (size_t i = 0; i < ids.size(); i++) {
+                int &slot = slots[static_cast<size_t>(ids[i] - base)];
+                if (slot == npos) {
+                    slot = static_cast<int>(i);
+                    count++;
+                }
+            }
+        } else {
+            dense = false;
+            hashed.reserve(ids.size());
+            for (size_t i = 0; i < ids.size(); i++) {
+                hashed.insert(std::make_pair(ids[i], static_cast<int>(i)));
+            }
+            count = hashed.size();
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 直接下标数组的只读视图（仅 isDense() 时有效），供批量计票等内核使用
+    bool isDense() const { return dense; }
+    int denseBase() const { return base; }
+    const std::vector<int>& denseSlots() const { return slots; }
+
+private:
+    bool dense;
+    int base;                            // 数组模式下 slots[0] 对应的ID
+    size_t count;                        // 已登记的ID数量
+    std::vector<int> slots;              // 数组模式：slots[id - base] = 下标，空位为 npos
+    std::unordered_map<int, int> hashed; // 哈希模式
+
+    // 数组槽位数不超过 ID 数量的 8 倍（外加少量余量）时视为紧凑：
+    // 此时数组占用的内存不多于哈希表节点
+    static bool isCompact(long long span, size_t ids) {
+        return span > 0 && span <= static_cast<long long>(ids) * 8 + 64 && span <= INT_MAX;
+    }
+
+    void growTo(int newBase, size_t newSize) {
+        std::vector<int> grown(newSize, npos);
+        size_t shift = static_cast<size_t>(base - newBase);
+        std::copy(slots.begin(), slots.end(), grown.begin() + shift);
+        slots.swap(grown);
+        base = newBase;
+    }
+
+    void convertToHash() {
+        hashed.reserve(count + 1);
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i] != npos) {
+                hashed[base + static_cast<int>(i)] = slots[i];
+            }
+        }
+        slots.clear();
+        dense = false;
+    }
+};
+
+#endif // ID_INDEX_H
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 只读文件映射 ====================
+
+/**
+ * 只读映射整个文件（POSIX 使用 mmap，其他平台读入内存）
+ * 只接受普通文件；管道、终端等无法映射的输入 open 返回 false，由调用方改用流读取
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char *base;
+    size_t length;
+    bool mapped;
+    std::vector<uint64_t> fallback;     // 无 mmap 时的文件内容
+};
+
+#endif // MAPPED_FILE_H
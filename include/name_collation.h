@@ -0,0 +1,53 @@
+#ifndef NAME_COLLATION_H
+#define NAME_COLLATION_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// ==================== 姓名排序键与基数排序 ====================
+
+/**
+ * 姓名排序规则
+ * 为姓名生成一次性的字节序排序键：按字节比较两个键即得到姓名顺序，
+ * 排序时不再在比较函数里反复分类、转换姓名。
+ *
+ * 键的规则与原 Statistics::sortByName 一致：纯英文名排在其他名字之前，
+ * 英文名忽略大小写与空格；中文（或混合）名按以下方式之一生成键（进程内固定）：
+ *   - pinyin：内置 GB2312 码序（一级汉字按拼音、二级汉字按部首排列），不依赖系统 locale
+ *     （需 iconv，且以 ELECTION_BUILTIN_PINYIN=ON 编译）
+ *   - locale：zh_CN.UTF-8 本地化排序键
+ *   - bytes：UTF-8 原始字节序（以上均不可用时）
+ */
+class NameCollation {
+public:
+    /**
+     * 排序键引用：按 (key, id) 升序排序，index 为原始位置
+     */
+    struct KeyRef {
+        const std::string *key;
+        int id;
+        size_t index;
+    };
+
+    /**
+     * 生成姓名的排序键
+     * @param name 姓名（UTF-8）
+     * @return 排序键，非空
+     */
+    static std::string sortKey(const std::string &name);
+
+    /**
+     * 按 (排序键, id) 升序做 MSD 基数排序
+     * 时间复杂度：O(键的总字节数)，小分段退回比较排序
+     * @param items 待排序的键引用（原地排序）
+     */
+    static void radixSort(std::vector<KeyRef> &items);
+
+    /**
+     * 当前使用的中文排序方式（"pinyin"、"locale" 或 "bytes"）
+     */
+    static const char* activeMode();
+};
+
+#endif // NAME_COLLATION_H
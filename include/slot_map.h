@@ -0,0 +1,237 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// ==================== 带代数句柄的槽位表 ====================
+
+/**
+ * 槽位句柄：槽位号 + 代数
+ * 槽位被删除后代数加一，旧句柄随即失效，可被检测出来，不会误指向新插入的元素。
+ */
+struct SlotHandle {
+    uint32_t slot;
+    uint32_t generation;
+
+    SlotHandle() : slot(UINT32_MAX), generation(0) {}
+    SlotHandle(uint32_t s, uint32_t g) : slot(s), generation(g) {}
+
+    bool isNull() const { return slot == UINT32_MAX; }
+    bool operator==(const SlotHandle &other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+    bool operator!=(const SlotHandle &other) const { return !(*this == other); }
+};
+
+/**
+ * 槽位表（slot map）
+ * 元素紧密存放在一个数组中（遍历与按下标访问同 vector），另有一张槽位表把句柄映射到数组下标。
+ * 插入 O(1) 摊还并返回稳定的句柄；删除 O(1)：把最后一个元素移到空出的位置，空出的槽位进入空闲链表复用。
+ * 句柄在其他元素插入、删除后仍然有效；指针/引用与 vector 一样会在插入扩容或删除移动后失效，长期持有请使用句柄。
+ * 删除会打乱紧密数组的顺序；每个元素另带一个递增的插入序号，需要按添加顺序展示时用 insertionOrder / ordered。
+ */
+template <class T>
+class SlotMap {
+public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    SlotMap() : nextOrder(0), displaced(false) {}
+
+    /**
+     * 插入元素
+     * @return 新元素的句柄
+     */
+    SlotHandle insert(T value) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+        slots[slot].dense = static_cast<uint32_t>(values.size());
+        values.push_back(std::move(value));
+        denseToSlot.push_back(slot);
+        orderKeys.push_back(nextOrder++);
+        return SlotHandle(slot, slots[slot].generation);
+    }
+
+    /**
+     * 按句柄删除元素，O(1)
+     * @return true表示删除成功，false表示句柄已失效
+     */
+    bool erase(SlotHandle handle) {
+        size_t index = indexOf(handle);
+        if (index == npos) {
+            return false;
+        }
+        eraseAt(index);
+        return true;
+    }
+
+    /**
+     * 按数组下标删除元素，O(1)；原最后一个元素移到 index 处
+     */
+    void eraseAt(size_t index) {
+        uint32_t slot = denseToSlot[index];
+        size_t last = values.size() - 1;
+        if (index != last) {
+            values[index] = std::move(values[last]);
+            denseToSlot[index] = denseToSlot[last];
+            orderKeys[index] = orderKeys[last];
+            slots[denseToSlot[index]].dense = static_cast<uint32_t>(index);
+            displaced = true;
+        }
+        values.pop_back();
+        denseToSlot.pop_back();
+        orderKeys.pop_back();
+        if (values.empty()) {
+            displaced = false;
+        }
+        release(slot);
+    }
+
+    /**
+     * 按句柄取元素
+     * @return 元素指针，句柄失效时返回 nullptr
+     */
+    T* get(SlotHandle handle) {
+        size_t index = indexOf(handle);
+        return index == npos ? nullptr : &values[index];
+    }
+
+    const T* get(SlotHandle handle) const {
+        size_t index = indexOf(handle);
+        return index == npos ? nullptr : &values[index];
+    }
+
+    bool contains(SlotHandle handle) const { return indexOf(handle) != npos; }
+
+    /**
+     * 句柄对应的数组下标，句柄失效时返回 npos
+     */
+    size_t indexOf(SlotHandle handle) const {
+        if (handle.slot >= slots.size()) {
+            return npos;
+        }
+        const Slot &s = slots[handle.slot];
+        if (s.generation != handle.generation || s.dense == kFree) {
+            return npos;
+        }
+        return s.dense;
+    }
+
+    /**
+     * 数组下标处元素的句柄
+     */
+    SlotHandle handleAt(size_t index) const {
+        uint32_t slot = denseToSlot[index];
+        return SlotHandle(slot, slots[slot].generation);
+    }
+
+    /**
+     * 按插入顺序排列的数组下标
+     * 未发生过移动元素的删除时即 0..n-1，O(n)；否则按插入序号排序，O(n log n)
+     */
+    std::vector<size_t> insertionOrder() const {
+        std::vector<size_t> order(values.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        if (displaced) {
+            const std::vector<uint64_t> &keys = orderKeys;
+            std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+        }
+        return order;
+    }
+
+    /**
+     * 按插入顺序复制全部元素（表格展示、保存、导出使用）
+     */
+    std::vector<T> ordered() const {
+        if (!displaced) {
+            return values;
+        }
+        std::vector<T> result;
+        result.reserve(values.size());
+        for (size_t i : insertionOrder()) {
+            result.push_back(values[i]);
+        }
+        return result;
+    }
+
+    // 紧密数组的顺序是否仍与插入顺序一致
+    bool inInsertionOrder() const { return !displaced; }
+
+    /**
+     * 清空；已发出的句柄全部失效
+     */
+    void clear() {
+        for (uint32_t slot : denseToSlot) {
+            release(slot);
+        }
+        values.clear();
+        denseToSlot.clear();
+        orderKeys.clear();
+        displaced = false;
+    }
+
+    void reserve(size_t n) {
+        values.reserve(n);
+        denseToSlot.reserve(n);
+        orderKeys.reserve(n);
+        slots.reserve(n);
+    }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    T& operator[](size_t index) { return values[index]; }
+    const T& operator[](size_t index) const { return values[index]; }
+    T& back() { return values.back(); }
+    const T& back() const { return values.back(); }
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+    // 紧密数组的只读视图（统计、计票等与顺序无关的遍历）；按添加顺序展示请用 ordered()
+    const std::vector<T>& dense() const { return values; }
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+private:
+    static const uint32_t kFree = UINT32_MAX;
+
+    struct Slot {
+        uint32_t dense;      // 元素在 values 中的下标，空闲时为 kFree
+        uint32_t generation; // 每次释放加一
+        Slot() : dense(kFree), generation(0) {}
+    };
+
+    std::vector<T> values;
+    std::vector<uint32_t> denseToSlot;  // values[i] 所在的槽位
+    std::vector<uint64_t> orderKeys;    // values[i] 的插入序号（随元素一起移动）
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint64_t nextOrder;
+    bool displaced;                     // 是否有元素因删除被移出插入顺序
+
+    void release(uint32_t slot) {
+        slots[slot].dense = kFree;
+        slots[slot].generation++;
+        freeSlots.push_back(slot);
+    }
+};
+
+template <class T>
+const size_t SlotMap<T>::npos;
+
+#endif // SLOT_MAP_H
@@ -0,0 +1,182 @@
+#ifndef SNAPSHOT_FILE_H
+#define SNAPSHOT_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "mapped_file.h"
+
+// ==================== 二进制快照文件 ====================
+
+/**
+ * 快照文件头（64字节，位于文件开头）
+ * 正文由8字节对齐的定长字段与数组组成，按本机字节序（小端）存放，
+ * 映射到内存后数组可直接引用或整块复制，无需逐行解析。
+ */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // 写入时为 kByteOrderMark，字节序不同的机器读到的值不同
+    uint64_t fileSize;
+    uint64_t checksum;          // 正文（文件头之后全部字节）的校验和
+    uint64_t topicCount;
+    uint64_t voterCount;
+    uint64_t voteCount;         // 投票历史总条数
+    uint64_t reserved;
+};
+
+/**
+ * 快照写入：正文先写入 path 的临时文件，同时累计校验和；
+ * commit 时回填文件头、落盘并重命名为 path，写入中途失败不会破坏已有快照。
+ */
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter &) = delete;
+
+    bool open(const std::string &path);
+
+    void write(const void *data, size_t size);
+    template <class T>
+    void writeValue(const T &value) { write(&value, sizeof(T)); }
+    /**
+     * 写入数组：元素个数（u64）+ 元素，之后补齐到8字节
+     */
+    template <class T>
+    void writeArray(const T *data, size_t count) {
+        writeValue<uint64_t>(count);
+        write(data, count * sizeof(T));
+        align();
+    }
+    template <class T>
+    void writeArray(const std::vector<T> &values) { writeArray(values.data(), values.size()); }
+    // 补齐到8字节
+    void align();
+
+    /**
+     * 写入文件头并完成快照
+     * @param header 文件头（magic/version/byteOrder/fileSize/checksum 由本函数填写）
+     * @return true表示成功
+     */
+    bool commit(SnapshotHeader header);
+
+    bool good() const { return ok; }
+
+private:
+    FILE *file;
+    std::string target;
+    std::string tempPath;
+    std::vector<char> buffer;
+    size_t used;
+    uint64_t offset;            // 正文已写入的字节数
+    uint64_t checksum;
+    bool ok;
+
+    void flushBuffer();
+};
+
+/**
+ * 快照读取：在映射的正文上顺序读取；数组以指针形式返回，指向映射内存，不复制。
+ * 越界时置为失败，之后的读取均失败。
+ */
+class SnapshotReader {
+public:
+    SnapshotReader(const char *data, size_t size) : p(data), begin(data), end(data + size), ok(true) {}
+
+    template <class T>
+    bool readValue(T &value) {
+        if (!ok || static_cast<size_t>(end - p) < sizeof(T)) {
+            ok = false;
+            return false;
+        }
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    /**
+     * 读取 writeArray 写入的数组
+     * @param count 输出元素个数
+     * @return 指向映射内存的指针（按8字节对齐）；失败时返回 nullptr
+     */
+    template <class T>
+    const T* readArray(uint64_t &count) {
+        count = 0;
+        uint64_t n = 0;
+        if (!readValue(n) || n > static_cast<uint64_t>(end - p) / sizeof(T)) {
+            ok = false;
+            return nullptr;
+        }
+        const T *data = reinterpret_cast<const T*>(p);
+        p += n * sizeof(T);
+        align();
+        count = n;
+        return ok ? data : nullptr;
+    }
+
+    template <class T>
+    bool readArray(std::vector<T> &values) {
+        uint64_t n = 0;
+        const T *data = readArray<T>(n);
+        if (!data) {
+            return false;
+        }
+        values.assign(data, data + n);
+        return true;
+    }
+
+    void align() {
+        size_t pos = static_cast<size_t>(p - begin);
+        size_t pad = (8 - pos % 8) % 8;
+        if (static_cast<size_t>(end - p) < pad) {
+            ok = false;
+            p = end;
+            return;
+        }
+        p += pad;
+    }
+
+    bool good() const { return ok; }
+    bool atEnd() const { return p == end; }
+
+private:
+    const char *p;
+    const char *begin;
+    const char *end;
+    bool ok;
+};
+
+/**
+ * 快照格式常量与校验
+ */
+class SnapshotFormat {
+public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kByteOrderMark = 0x01020304u;
+
+    /**
+     * 检查文件头：magic、版本、字节序与文件长度，O(1)
+     * @param verifyChecksum 为 true 时再对正文计算校验和，O(文件大小)
+     */
+    static bool check(const char *data, size_t size, bool verifyChecksum);
+
+    /**
+     * 只读取文件头做快速检查（不映射正文）
+     * @param header 若非空，输出文件头
+     */
+    static bool checkFile(const std::string &path, SnapshotHeader *header = nullptr);
+
+    /**
+     * 流式校验和：按8字节字处理，size 须为8的倍数
+     */
+    static const uint64_t kChecksumSeed = 0x6a09e667f3bcc908ULL;
+    static uint64_t checksum(uint64_t state, const char *data, size_t size);
+};
+
+#endif // SNAPSHOT_FILE_H
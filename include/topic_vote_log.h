@@ -0,0 +1,184 @@
+#ifndef TOPIC_VOTE_LOG_H
+#define TOPIC_VOTE_LOG_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include "voter_dictionary.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ==================== 列式话题投票历史 ====================
+
+/**
+ * 话题投票历史的一条记录：投票人以句柄表示（见 VoterDictionary），不保存ID字符串；
+ * sequence 为全局投票序号（跨话题递增），用于恢复各话题记录之间的先后顺序
+ */
+struct TopicVoteEntry {
+    int topicId;
+    VoterHandle voter;
+    int optionId;
+    time_t votedAt;
+    uint64_t sequence;
+
+    TopicVoteEntry() : topicId(0), voter(VoterDictionary::kNoVoter), optionId(0), votedAt(0), sequence(0) {}
+    TopicVoteEntry(int t, VoterHandle v, int o, time_t ts, uint64_t seq = 0)
+        : topicId(t), voter(v), optionId(o), votedAt(ts), sequence(seq) {}
+};
+
+/**
+ * 单个话题的列式投票历史
+ * 记录按块存放（每块最多 kBlockSize 条），块内投票人句柄、选项ID、时间、全局序号各为一列紧凑数组；
+ * 时间与序号存为相对块起始值的32位偏移，每条记录16字节（话题ID由日志本身给出，不逐条保存）。
+ * 可选压缩：超出撤销窗口的旧块把各列按“与前一条的差值”做 zigzag 变长编码，
+ * 常见数据每条只需数个字节；撤销退回到压缩块时自动解压。
+ * 遍历（导出、分析、审计）按块顺序读取各列。
+ */
+class TopicVoteLog {
+public:
+    static const size_t kBlockSize = 4096;
+    static const size_t kDefaultUndoWindow = 1u << 16;
+
+    explicit TopicVoteLog(int topicId = 0);
+
+    int topic() const { return topicId; }
+
+    /**
+     * 追加一条记录（entry.topicId 被忽略；序号须不小于上一条）
+     */
+    void append(const TopicVoteEntry &entry);
+
+    /**
+     * 最后一条记录（日志不能为空）
+     */
+    TopicVoteEntry back() const;
+
+    /**
+     * 移除最后一条记录（日志不能为空）
+     */
+    void popBack();
+
+    void clear();
+    void reserve(size_t n);
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * 设置旧块压缩
+     * @param enabled 是否压缩
+     * @param undoWindow 最近的多少条记录保持不压缩（撤销时无需解压）
+     */
+    void setCompression(bool enabled, size_t undoWindow = kDefaultUndoWindow);
+    bool compressionEnabled() const { return compress; }
+
+    /**
+     * 快照：逐块保存各列（压缩块保存压缩数据），载入时整块复制
+     */
+    void saveSnapshot(SnapshotWriter &out) const;
+    /**
+     * 从快照载入（替换现有内容；压缩设置保持不变）
+     * 不论文件是否校验过校验和，都检查块布局、压缩数据的边界与投票人句柄
+     * @param voterCount 投票人字典的大小，句柄须小于该值
+     * @return true表示成功，false表示数据不一致（此时日志为空）
+     */
+    bool loadSnapshot(SnapshotReader &in, size_t voterCount);
+
+    /**
+     * 当前占用的内存字节数（各列与压缩数据的容量之和，近似值）
+     */
+    size_t memoryBytes() const;
+
+    /**
+     * 按投票顺序遍历全部记录
+     * @param fn 对每条记录调用 fn(const TopicVoteEntry&)
+     */
+    template <class Fn>
+    void forEach(Fn fn) const {
+        Columns scratch;
+        for (const auto &block : blocks) {
+            const Columns &cols = block.packed.empty() ? block.columns : (unpack(block, scratch), scratch);
+            size_t n = cols.size();
+            for (size_t i = 0; i < n; i++) {
+                fn(entryAt(block, cols, i));
+            }
+        }
+    }
+
+private:
+    struct Columns {
+        std::vector<uint32_t> voters;
+        std::vector<int32_t> options;
+        std::vector<int32_t> timeOffsets;   // 相对 Block::baseTime 的秒数
+        std::vector<uint32_t> seqOffsets;   // 相对 Block::baseSequence 的序号差
+
+        size_t size() const { return voters.size(); }
+        void clear();
+        void reserve(size_t n);
+        void release();
+        void popBack();
+        size_t capacityBytes() const;
+    };
+
+    struct Block {
+        int64_t baseTime;
+        uint64_t baseSequence;
+        Columns columns;        // 未压缩时的数据
+        std::string packed;     // 压缩后的数据（非空表示已压缩，columns 为空）
+        uint32_t packedCount;   // 压缩块的记录数
+
+        Block() : baseTime(0), baseSequence(0), packedCount(0) {}
+        size_t size() const { return packed.empty() ? columns.size() : packedCount; }
+    };
+
+    int topicId;
+    std::vector<Block> blocks;
+    size_t count;
+    bool compress;
+    size_t undoWindow;
+    size_t firstUncompressed;   // 该下标之前的块已移出撤销窗口（开启压缩时已压缩）
+    size_t coldCount;           // 这些块中的记录数
+
+    TopicVoteEntry entryAt(const Block &block, const Columns &cols, size_t i) const {
+        return TopicVoteEntry(topicId, cols.voters[i], cols.options[i],
+                              static_cast<time_t>(block.baseTime + cols.timeOffsets[i]),
+                              block.baseSequence + cols.seqOffsets[i]);
+    }
+
+    static void pack(Block &block);
+    // 压缩数据不完整或有多余字节时返回 false（pack 生成的数据总能解码）
+    static bool unpack(const Block &block, Columns &out);
+    void compressColdBlocks();
+
+public:
+    /**
+     * 顺序读取游标：按投票顺序逐条读取，供多个话题按全局序号归并
+     * 进入压缩块时解压到游标自带的缓冲区；遍历期间日志不能被修改
+     */
+    class Cursor {
+    public:
+        explicit Cursor(const TopicVoteLog &log);
+
+        bool valid() const { return block < log->blocks.size(); }
+        // 当前记录的全局序号（valid() 时可用）
+        uint64_t sequence() const { return log->blocks[block].baseSequence + columns().seqOffsets[index]; }
+        TopicVoteEntry entry() const { return log->entryAt(log->blocks[block], columns(), index); }
+        void next();
+
+    private:
+        const TopicVoteLog *log;
+        size_t block;
+        size_t index;
+        Columns scratch;    // 当前块为压缩块时的解压数据
+
+        const Columns& columns() const {
+            const Block &b = log->blocks[block];
+            return b.packed.empty() ? b.columns : scratch;
+        }
+        void enterBlock();
+    };
+};
+
+#endif // TOPIC_VOTE_LOG_H
@@ -0,0 +1,54 @@
+#ifndef VOTE_HISTOGRAM_H
+#define VOTE_HISTOGRAM_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 批量计票直方图内核 ====================
+
+/**
+ * 选票直方图
+ * 对投票向量统计每个ID的出现次数，只访问紧凑的计数数组，不触碰 Candidate 结构体。
+ * 内部使用4个子直方图轮流累加，避免同一热门候选人连续写同一地址造成的存储-加载依赖；
+ * 支持 AVX2 时用向量指令完成ID换算与范围校验，否则使用标量实现（运行时选择）。
+ */
+class VoteHistogram {
+public:
+    enum class Kernel {
+        Auto,    // 运行时检测，优先 AVX2
+        Scalar,  // 强制标量实现
+        Avx2     // 强制 AVX2（CPU 不支持时退回标量）
+    };
+
+    /**
+     * 统计 votes 中落在 [base, base + range) 内的ID出现次数
+     * @param votes 投票数组
+     * @param n 投票数量
+     * @param base 计数数组下标0对应的ID
+     * @param range 计数数组长度
+     * @param counts 计数数组（长度为 range，在原值基础上累加）
+     * @param outOfRangePositions 若非空，追加范围外选票的位置（从0开始）
+     * @return 范围外的选票数量
+     */
+    static size_t count(const int *votes, size_t n, int base, size_t range,
+                        uint64_t *counts,
+                        std::vector<size_t> *outOfRangePositions = nullptr);
+
+    /**
+     * 设置优先使用的内核（主要用于基准测试对比）
+     */
+    static void setKernel(Kernel kernel);
+
+    /**
+     * 当前CPU是否支持 AVX2 内核
+     */
+    static bool avx2Available();
+
+    /**
+     * 实际将使用的内核名称（"avx2" 或 "scalar"）
+     */
+    static const char* activeKernelName();
+};
+
+#endif // VOTE_HISTOGRAM_H
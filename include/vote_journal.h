@@ -0,0 +1,204 @@
+#ifndef VOTE_JOURNAL_H
+#define VOTE_JOURNAL_H
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// ==================== 话题投票预写日志 ====================
+
+/**
+ * 日志事件类型（写入文件，数值不可改变）
+ */
+enum class JournalEvent : uint8_t {
+    Clear = 1,          // 清空全部话题、投票人与投票历史
+    PutTopic = 2,       // 写入整个话题（含选项票数）与下一个话题ID
+    DeleteTopic = 3,    // 删除话题
+    Cast = 4,           // 实名投票：话题、选项、投票时间、投票人ID
+    AnonymousCast = 5,  // 不记名投票：话题、选项
+    Undo = 6,           // 撤销话题最近一次投票
+    RestoreVote = 7     // 导入的投票记录：写入历史与投票人限制，不计票
+};
+
+/**
+ * 日志记录编码：事件类型 + 小端序定长整数与带长度前缀的字符串
+ */
+class JournalEncoder {
+public:
+    JournalEncoder() : event(JournalEvent::Clear) {}
+
+    // 开始一条新记录（复用内部缓冲区）
+    void reset(JournalEvent e) {
+        event = e;
+        payload.clear();
+    }
+
+    void putU32(uint32_t v) {
+        char b[4];
+        for (int i = 0; i < 4; i++) b[i] = static_cast<char>(v >> (8 * i));
+        payload.append(b, 4);
+    }
+    void putI32(int32_t v) { putU32(static_cast<uint32_t>(v)); }
+    void putI64(int64_t v) {
+        putU32(static_cast<uint32_t>(static_cast<uint64_t>(v)));
+        putU32(static_cast<uint32_t>(static_cast<uint64_t>(v) >> 32));
+    }
+    void putString(const std::string &s) {
+        putU32(static_cast<uint32_t>(s.size()));
+        payload.append(s);
+    }
+
+    JournalEvent type() const { return event; }
+    const std::string& bytes() const { return payload; }
+
+private:
+    JournalEvent event;
+    std::string payload;
+};
+
+/**
+ * 日志记录解码；越界读取时置为失败，之后的读取均返回0/空串
+ */
+class JournalDecoder {
+public:
+    JournalDecoder(JournalEvent e, const char *data, size_t size)
+        : event(e), p(data), end(data + size), ok(true) {}
+
+    uint32_t getU32() {
+        if (end - p < 4) {
+            ok = false;
+            p = end;
+            return 0;
+        }
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        p += 4;
+        return v;
+    }
+    int32_t getI32() { return static_cast<int32_t>(getU32()); }
+    int64_t getI64() {
+        uint64_t lo = getU32();
+        uint64_t hi = getU32();
+        return static_cast<int64_t>(lo | (hi << 32));
+    }
+    std::string getString() {
+        uint32_t n = getU32();
+        if (static_cast<size_t>(end - p) < n) {
+            ok = false;
+            p = end;
+            return std::string();
+        }
+        std::string s(p, n);
+        p += n;
+        return s;
+    }
+
+    JournalEvent type() const { return event; }
+    // 到目前为止的读取都在记录范围内
+    bool good() const { return ok; }
+    // 所有读取都在记录范围内且恰好读完
+    bool valid() const { return ok && p == end; }
+
+private:
+    JournalEvent event;
+    const char *p;
+    const char *end;
+    bool ok;
+};
+
+/**
+ * 只追加的二进制投票日志（预写日志）
+ * 文件由8字节文件头和若干记录组成，每条记录为 [负载长度 u32][事件 u8][负载][CRC32 u32]。
+ * append 只把编码后的记录追加到内存缓冲区；后台线程按组提交：每隔 flushIntervalMs 毫秒
+ * 或待写记录达到 flushRecords 条时，一次写入整批记录并 fsync，多次投票共用一次落盘。
+ * 崩溃时最多丢失最近一个提交周期内的记录；末尾写了一半的记录在重放时被识别并丢弃。
+ */
+class VoteJournal {
+public:
+    struct Options {
+        unsigned flushIntervalMs;   // 组提交间隔（毫秒）
+        size_t flushRecords;        // 待写记录达到该数量时立即提交
+        bool syncToDisk;            // 提交时 fsync；为 false 时只写入操作系统缓存
+
+        Options() : flushIntervalMs(5), flushRecords(4096), syncToDisk(true) {}
+    };
+
+    VoteJournal();
+    ~VoteJournal();
+
+    VoteJournal(const VoteJournal &) = delete;
+    VoteJournal& operator=(const VoteJournal &) = delete;
+
+    /**
+     * 打开日志并启动后台写线程
+     * @param path 日志文件路径
+     * @param validLength 文件中有效数据的长度（由 replay 得到）；文件更长时截断，为0时新建
+     * @param options 组提交参数
+     * @return true表示成功
+     */
+    bool open(const std::string &path, uint64_t validLength, const Options &options = Options());
+
+    /**
+     * 提交剩余记录并关闭文件
+     */
+    void close();
+
+    bool isOpen() const { return file != nullptr; }
+
+    /**
+     * 追加一条记录（只写入内存缓冲区，由后台线程提交）
+     */
+    void append(const JournalEncoder &record);
+
+    /**
+     * 等待此前追加的记录全部提交
+     * @return true表示没有发生写入错误
+     */
+    bool sync();
+
+    // 是否发生过写入错误（发生后不再写入，已追加的记录不保证落盘）
+    bool failed() const;
+
+    // 文件中已提交数据的长度（文件头 + 已落盘的记录）
+    uint64_t length() const;
+
+    /**
+     * 按顺序读取日志中的全部有效记录
+     * 遇到不完整或校验失败的记录即停止（视为崩溃时写了一半的尾部）；
+     * 校验通过但 fn 拒绝的记录只跳过，不影响其后的记录
+     * @param path 日志文件路径
+     * @param fn 对每条记录调用 fn(JournalDecoder&)，返回 false 表示该记录无法应用
+     * @param validLength 输出有效数据的长度（文件不存在时为0），包含被跳过的记录
+     * @param records 若非空，输出成功应用的记录数
+     * @param rejected 若非空，输出被 fn 拒绝而跳过的记录数
+     * @return true表示文件不存在或文件头正确，false表示无法读取或不是投票日志
+     */
+    static bool replay(const std::string &path, const std::function<bool(JournalDecoder&)> &fn,
+                       uint64_t *validLength, uint64_t *records = nullptr, uint64_t *rejected = nullptr);
+
+private:
+    FILE *file;
+    Options opts;
+    std::thread writer;
+    mutable std::mutex mutex;
+    std::condition_variable wake;       // 通知写线程
+    std::condition_variable committed;  // 通知等待提交的线程
+    std::string pending;                // 待提交的已编码记录
+    size_t pendingRecords;
+    uint64_t appendedCount;             // 已追加记录数
+    uint64_t committedCount;            // 已提交记录数
+    uint64_t committedBytes;            // 文件中已提交数据的长度
+    bool flushRequested;
+    bool stopping;
+    bool error;
+
+    void writerLoop();
+    bool writeBatch(const std::string &batch);
+};
+
+#endif // VOTE_JOURNAL_H
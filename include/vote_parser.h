@@ -0,0 +1,299 @@
+#ifndef VOTE_PARSER_H
+#define VOTE_PARSER_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "mapped_file.h"
+
+// ==================== 投票数据快速解析 ====================
+
+/**
+ * 投票ID解析（不分配内存、不抛异常）
+ * 单个整数的语义与 std::stoi 相同：跳过前导空白，可选正负号，取最长的十进制数字前缀，其后的字符忽略；
+ * 没有数字或超出 int 范围时视为无效（原实现中 stoi 抛出异常的情况）。
+ * 数字按8字节一组用 SWAR（在64位寄存器内并行处理8个字节）判断与转换，常见的1~8位ID不逐字节循环。
+ */
+class VoteParser {
+public:
+    // 与 C locale 的 isspace 相同：空格、\t \n \v \f \r
+    static bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+    /**
+     * 解析 [p, end) 开头的整数
+     * @param value 解析结果（输出参数）
+     * @return 最后一个数字之后的位置；无效时返回 nullptr
+     */
+    static const char* parseInt(const char *p, const char *end, int &value) {
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            p++;
+        }
+
+        size_t avail = static_cast<size_t>(end - p);
+        uint64_t word = 0;
+        std::memcpy(&word, p, avail < 8 ? avail : 8);   // 不足8字节时补0，0不是数字
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        // 每个字节减去'0'（异或与减法对数字字节等价）；数字字节得到0~9，其余字节加0x76后最高位为1
+        uint64_t digits = word ^ 0x3030303030303030ULL;
+        uint64_t nonDigit = ((digits + 0x7676767676767676ULL) | digits) & 0x8080808080808080ULL;
+        size_t n = nonDigit ? lowestSetBit(nonDigit) / 8 : 8;
+        if (n == 0) {
+            return nullptr;
+        }
+
+        uint64_t magnitude = 0;
+        const char *q = p + n;
+        if (n < 8) {
+            // 把n个数字移到高位（低位补0即前导零），三次乘法合并为一个整数
+            digits <<= (8 - n) * 8;
+            digits = (digits * 2561) >> 8;
+            digits = ((digits & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+            magnitude = ((digits & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+        } else {
+            // 8位以上（含前导零）的长数字逐位累加；超出范围后不再累加，避免回绕
+            q = p;
+            while (q < end && static_cast<unsigned>(*q - '0') < 10) {
+                if (magnitude <= kMaxMagnitude) {
+                    magnitude = magnitude * 10 + static_cast<unsigned>(*q - '0');
+                }
+                q++;
+            }
+        }
+
+        if (magnitude > kMaxMagnitude - (negative ? 0 : 1)) {
+            return nullptr;
+        }
+        value = negative ? static_cast<int>(-static_cast<int64_t>(magnitude)) : static_cast<int>(magnitude);
+        return q;
+    }
+
+    /**
+     * 解析 [p, end) 开头的64位整数（语义同 std::stoll，不使用 SWAR，用于时间戳等较长的字段）
+     * @return 最后一个数字之后的位置；无效时返回 nullptr
+     */
+    static const char* parseInt64(const char *p, const char *end, long long &value) {
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            p++;
+        }
+        const char *digits = p;
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+            unsigned d = static_cast<unsigned>(*p - '0');
+            if (magnitude > (kMaxMagnitude64 - d) / 10) {
+                overflow = true;
+            } else {
+                magnitude = magnitude * 10 + d;
+            }
+            p++;
+        }
+        if (p == digits || overflow || magnitude > kMaxMagnitude64 - (negative ? 0 : 1)) {
+            return nullptr;
+        }
+        value = negative ? -static_cast<long long>(magnitude - 1) - 1 : static_cast<long long>(magnitude);
+        return p;
+    }
+
+    /**
+     * 解析整块投票数据（格式规则与 FileManager::loadVotes 相同）
+     * CSV 格式按行处理：每行取开头的整数，非数字行（例如表头）跳过；
+     * 文本格式按空白分隔为 token，每个 token 取开头的整数，非数字 token 跳过。
+     * @param textFormat true表示文本格式，false表示CSV格式
+     * @param sink 对每个投票ID依次调用 sink(int)，可写入调用方的数组或直接计票
+     * @return 投票ID个数
+     */
+    template <class Sink>
+    static size_t parse(const char *data, size_t size, bool textFormat, Sink &&sink) {
+        const char *p = data;
+        const char *end = data + size;
+        size_t count = 0;
+        int value = 0;
+        if (textFormat) {
+            while (p < end) {
+                while (p < end && isSpace(*p)) {
+                    p++;
+                }
+                if (p == end) {
+                    break;
+                }
+                const char *q = parseInt(p, end, value);
+                if (q) {
+                    sink(value);
+                    count++;
+                    p = q;
+                }
+                while (p < end && !isSpace(*p)) {
+                    p++;
+                }
+            }
+            return count;
+        }
+
+        while (p < end) {
+            // 前导空白可能越过空行进入下一行，结果与逐行去空白后解析相同
+            const char *q = parseInt(p, end, value);
+            if (q) {
+                sink(value);
+                count++;
+                p = q;
+            }
+            if (p < end && *p == '\n') {
+                p++;
+                continue;
+            }
+            const char *newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            p = newline ? newline + 1 : end;
+        }
+        return count;
+    }
+
+    /**
+     * 映射文件并解析
+     * @param path 文件路径（须为普通文件）
+     * @param size 若非空，输出文件字节数
+     * @return true表示成功；文件无法映射（不存在、管道等）时返回 false
+     */
+    template <class Sink>
+    static bool parseFile(const std::string &path, bool textFormat, Sink &&sink, size_t *size = nullptr) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        parse(file.data(), file.size(), textFormat, sink);
+        if (size) {
+            *size = file.size();
+        }
+        return true;
+    }
+
+private:
+    static const uint64_t kMaxMagnitude = 2147483648ULL;            // |INT_MIN|
+    static const uint64_t kMaxMagnitude64 = 9223372036854775808ULL; // |LLONG_MIN|
+
+    static unsigned lowestSetBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned i = 0;
+        while (!(mask & 1u)) {
+            mask >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+};
+
+/**
+ * 分块解析：输入可在任意字节处切块，被切断的行（CSV）或 token（文本格式）暂存，与下一块拼接后再解析；
+ * 结果与把全部数据一次交给 VoteParser::parse 相同。暂存部分只是一行/一个 token，不随输入增长。
+ */
+class VoteChunkParser {
+public:
+    explicit VoteChunkParser(bool textFormat) : textFormat(textFormat) {}
+
+    /**
+     * 解析一块数据（末尾不完整的行/token 留待下一块）
+     * @return 本次产出的投票ID个数
+     */
+    template <class Sink>
+    size_t feed(const char *data, size_t size, Sink &&sink) {
+        const char *end = data + size;
+        size_t count = 0;
+        if (!carry.empty()) {
+            const char *first = data;
+            while (first < end && !isDelimiter(*first)) {
+                first++;
+            }
+            if (first == end) {
+                carry.append(data, size);
+                return 0;
+            }
+            carry.append(data, static_cast<size_t>(first + 1 - data));
+            count += VoteParser::parse(carry.data(), carry.size(), textFormat, sink);
+            carry.clear();
+            data = first + 1;
+        }
+        const char *last = end;
+        while (last > data && !isDelimiter(last[-1])) {
+            last--;
+        }
+        count += VoteParser::parse(data, static_cast<size_t>(last - data), textFormat, sink);
+        carry.assign(last, end);
+        return count;
+    }
+
+    /**
+     * 输入结束：解析暂存的最后一行/token
+     */
+    template <class Sink>
+    size_t finish(Sink &&sink) {
+        size_t count = VoteParser::parse(carry.data(), carry.size(), textFormat, sink);
+        carry.clear();
+        return count;
+    }
+
+private:
+    bool textFormat;
+    std::string carry;      // 上一块末尾被切断的部分
+
+    bool isDelimiter(char c) const { return textFormat ? VoteParser::isSpace(c) : c == '\n'; }
+};
+
+/**
+ * 分块预读：后台线程按固定大小把输入流读入两个缓冲区轮流使用，
+ * 调用方处理当前块时下一块已在读取；内存占用固定为 2 × chunkBytes。
+ */
+class ChunkPrefetcher {
+public:
+    ChunkPrefetcher(std::istream &in, size_t chunkBytes);
+    ~ChunkPrefetcher();
+
+    ChunkPrefetcher(const ChunkPrefetcher &) = delete;
+    ChunkPrefetcher& operator=(const ChunkPrefetcher &) = delete;
+
+    /**
+     * 取得下一块数据（上一次取得的块随之交还给读线程，其指针失效）
+     * @return false 表示输入已读完
+     */
+    bool next(const char *&data, size_t &size);
+
+    // 已交给调用方的总字节数
+    uint64_t bytesConsumed() const { return consumed; }
+
+private:
+    std::istream &in;
+    std::vector<char> buffers[2];
+    size_t filled[2];           // 缓冲区中的数据字节数
+    bool full[2];               // true 表示已读入、等待调用方取走
+    size_t current;             // 下一次 next 取用的缓冲区
+    bool holding;               // 调用方是否持有上一块（对应 current 的另一个缓冲区）
+    bool finished;              // 读线程已读到输入末尾
+    bool stopping;
+    uint64_t consumed;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread reader;
+
+    void readLoop();
+};
+
+#endif // VOTE_PARSER_H
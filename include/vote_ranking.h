@@ -0,0 +1,234 @@
+#ifndef VOTE_RANKING_H
+#define VOTE_RANKING_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
+#include "id_index.h"
+
+// ==================== 增量维护的得票排名 ====================
+
+/**
+ * 按得票数降序维护的排名数组（分桶计数表）
+ * 所有对象按票数降序存放在一个数组中，相同票数的对象构成连续的一段（桶），
+ * 并记录每个桶的起始位置。票数 +1/-1 时只需把对象与所在桶的首/尾元素交换、
+ * 移动桶边界，O(1) 完成；前K名即数组前K项，名次即所在桶的起始位置。
+ * 同票对象之间的先后顺序不作保证（重建时按 key 升序）。
+ */
+class VoteRanking {
+public:
+    VoteRanking() {}
+
+    void clear() {
+        entries.clear();
+        positions.clear();
+        buckets.clear();
+    }
+
+    /**
+     * 按当前计数整体重建，O(n log n)
+     * @param items 计数对象容器
+     * @param keyOf 取 key 的函数
+     * @param countOf 取计数的函数
+     */
+    template <class Container, class KeyFn, class CountFn>
+    void rebuild(const Container &items, KeyFn keyOf, CountFn countOf) {
+        clear();
+        entries.reserve(items.size());
+        for (const auto &item : items) {
+            entries.push_back(Entry(keyOf(item), countOf(item)));
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.count != b.count ? a.count > b.count : a.key < b.key;
+        });
+        std::vector<int> keys;
+        keys.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            keys.push_back(entries[i].key);
+            Bucket &b = buckets[entries[i].count];
+            if (b.size == 0) b.start = i;
+            b.size++;
+        }
+        positions.rebuild(keys);
+    }
+
+    /**
+     * 新增对象，O(比它票数低的桶数)；票数为0的新对象 O(1)
+     */
+    void add(int key, int count) {
+        size_t pos = entries.size();
+        entries.push_back(Entry(key, count));
+        positions.insert(key, static_cast<int>(pos));
+        // 从末尾开始，与每个票数更低的桶的首元素交换，逐桶上移到目标位置
+        while (pos > 0 && entries[pos - 1].count < count) {
+            Bucket &b = buckets.find(entries[pos - 1].count)->second;
+            size_t first = b.start;
+            swapEntries(pos, first);
+            b.start++;
+            pos = first;
+        }
+        Bucket &target = buckets[count];
+        if (target.size == 0) target.start = pos;
+        target.size++;
+    }
+
+    /**
+     * 删除对象，O(比它票数低的桶数)
+     * @return true表示删除成功，false表示对象不存在
+     */
+    bool remove(int key) {
+        int found = positions.find(key);
+        if (found == AdaptiveIdIndex::npos) {
+            return false;
+        }
+        size_t pos = static_cast<size_t>(found);
+        int count = entries[pos].count;
+
+        auto it = buckets.find(count);
+        size_t last = it->second.start + it->second.size - 1;
+        swapEntries(pos, last);
+        pos = last;
+        if (--it->second.size == 0) buckets.erase(it);
+
+        // 与每个票数更低的桶的尾元素交换，把待删对象逐桶下移到数组末尾
+        while (pos + 1 < entries.size()) {
+            Bucket &b = buckets.find(entries[pos + 1].count)->second;
+            size_t end = b.start + b.size - 1;
+            swapEntries(pos, end);
+            b.start = pos;
+            pos = end;
+        }
+        entries.pop_back();
+        positions.erase(key);
+        return true;
+    }
+
+    /**
+     * 票数加一，O(1)
+     * @return true表示成功，false表示对象不存在
+     */
+    bool increment(int key) {
+        int found = positions.find(key);
+        if (found == AdaptiveIdIndex::npos) {
+            return false;
+        }
+        size_t pos = static_cast<size_t>(found);
+        int count = entries[pos].count;
+        auto it = buckets.find(count);
+        size_t first = it->second.start;
+        swapEntries(pos, first);
+        entries[first].count = count + 1;
+        it->second.start++;
+        if (--it->second.size == 0) buckets.erase(it);
+
+        Bucket &up = buckets[count + 1];
+        if (up.size == 0) up.start = first;
+        up.size++;
+        return true;
+    }
+
+    /**
+     * 票数减一，O(1)
+     * @return true表示成功，false表示对象不存在或票数已为0
+     */
+    bool decrement(int key) {
+        int found = positions.find(key);
+        if (found == AdaptiveIdIndex::npos || entries[found].count <= 0) {
+            return false;
+        }
+        size_t pos = static_cast<size_t>(found);
+        int count = entries[pos].count;
+        auto it = buckets.find(count);
+        size_t last = it->second.start + it->second.size - 1;
+        swapEntries(pos, last);
+        entries[last].count = count - 1;
+        if (--it->second.size == 0) buckets.erase(it);
+
+        Bucket &down = buckets[count - 1];
+        down.start = last;   // 下一个桶紧接在后面，新成员成为它的首元素
+        down.size++;
+        return true;
+    }
+
+    bool contains(int key) const { return positions.contains(key); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    /**
+     * 对象票数，不存在时返回0
+     */
+    int countOf(int key) const {
+        int pos = positions.find(key);
+        return pos == AdaptiveIdIndex::npos ? 0 : entries[pos].count;
+    }
+
+    int maxCount() const { return entries.empty() ? 0 : entries.front().count; }
+    int minCount() const { return entries.empty() ? 0 : entries.back().count; }
+
+    // 第 i 名（从0开始）的 key 与票数
+    int keyAt(size_t i) const { return entries[i].key; }
+    int countAt(size_t i) const { return entries[i].count; }
+
+    /**
+     * 名次（从1开始，同票同名次：1 + 票数严格更高的对象数），O(1)
+     * @return 名次，不存在时返回0
+     */
+    size_t rankOf(int key) const {
+        int pos = positions.find(key);
+        if (pos == AdaptiveIdIndex::npos) {
+            return 0;
+        }
+        return buckets.find(entries[pos].count)->second.start + 1;
+    }
+
+    /**
+     * 与第一名相差的票数，O(1)；不存在时返回-1
+     */
+    int votesBehindLeader(int key) const {
+        int pos = positions.find(key);
+        if (pos == AdaptiveIdIndex::npos) {
+            return -1;
+        }
+        return entries.front().count - entries[pos].count;
+    }
+
+    /**
+     * 前K名的 key（按票数降序），O(K)
+     * @param k 数量，0 表示全部
+     */
+    std::vector<int> topK(size_t k = 0) const {
+        size_t n = (k == 0 || k > entries.size()) ? entries.size() : k;
+        std::vector<int> keys;
+        keys.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            keys.push_back(entries[i].key);
+        }
+        return keys;
+    }
+
+private:
+    struct Entry {
+        int key;
+        int count;
+        Entry(int k, int c) : key(k), count(c) {}
+    };
+    struct Bucket {
+        size_t start;   // 桶内首个对象在 entries 中的位置
+        size_t size;
+        Bucket() : start(0), size(0) {}
+    };
+
+    std::vector<Entry> entries;                 // 按票数降序排列
+    AdaptiveIdIndex positions;                  // key -> entries 下标
+    std::unordered_map<int, Bucket> buckets;    // 票数 -> 桶
+
+    void swapEntries(size_t a, size_t b) {
+        if (a == b) return;
+        std::swap(entries[a], entries[b]);
+        positions.insert(entries[a].key, static_cast<int>(a));
+        positions.insert(entries[b].key, static_cast<int>(b));
+    }
+};
+
+#endif // VOTE_RANKING_H
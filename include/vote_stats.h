@@ -0,0 +1,101 @@
+#ifndef VOTE_STATS_H
+#define VOTE_STATS_H
+
+#include <cstddef>
+#include "vote_ranking.h"
+
+// ==================== 增量维护的得票统计 ====================
+
+/**
+ * 一组计数对象（候选人或话题选项）的增量统计
+ * 维护总票数与按票数降序的排名（VoteRanking），每次投票/撤销 O(1) 更新；
+ * 总票数、最高/最低票数、严格过半的领先者、前K名与名次均可 O(1) 查询。
+ * 计数对象以 key（候选人ID或选项ID）标识；调用方在改动计数时同步通知本对象。
+ */
+class VoteCountStats {
+public:
+    static const int kNoLeader = -1;
+
+    VoteCountStats() : totalVotes(0) {}
+
+    void clear() {
+        totalVotes = 0;
+        order.clear();
+    }
+
+    /**
+     * 按当前计数整体重建
+     * @param items 计数对象容器
+     * @param keyOf 取 key 的函数
+     * @param countOf 取计数的函数
+     */
+    template <class Container, class KeyFn, class CountFn>
+    void rebuild(const Container &items, KeyFn keyOf, CountFn countOf) {
+        totalVotes = 0;
+        for (const auto &item : items) {
+            totalVotes += countOf(item);
+        }
+        order.rebuild(items, keyOf, countOf);
+    }
+
+    /**
+     * 新增计数对象（例如添加候选人）
+     */
+    void add(int key, int count) {
+        totalVotes += count;
+        order.add(key, count);
+    }
+
+    /**
+     * 删除计数对象（例如删除候选人）
+     */
+    void remove(int key) {
+        totalVotes -= order.countOf(key);
+        order.remove(key);
+    }
+
+    /**
+     * 计数加一
+     */
+    void increment(int key) {
+        if (order.increment(key)) {
+            totalVotes++;
+        }
+    }
+
+    /**
+     * 计数减一（计数为0时不变）
+     */
+    void decrement(int key) {
+        if (order.decrement(key)) {
+            totalVotes--;
+        }
+    }
+
+    long long total() const { return totalVotes; }
+    int maxCount() const { return order.maxCount(); }
+    int minCount() const { return order.minCount(); }
+    size_t size() const { return order.size(); }
+
+    /**
+     * 严格过半的领先者：只可能是第一名，O(1)
+     * @return 领先者 key，没有则返回 kNoLeader
+     */
+    int leader() const {
+        if (order.empty() || 2LL * order.maxCount() <= totalVotes) {
+            return kNoLeader;
+        }
+        return order.keyAt(0);
+    }
+
+    /**
+     * 按票数降序的排名（前K名、名次、与第一名的差距）
+     */
+    const VoteRanking& ranking() const { return order; }
+
+private:
+    long long totalVotes;
+    VoteRanking order;
+};
+
+#endif // VOTE_STATS_H
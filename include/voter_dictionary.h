@@ -0,0 +1,82 @@
+#ifndef VOTER_DICTIONARY_H
+#define VOTER_DICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ==================== 投票人ID字典 ====================
+
+// 投票人句柄：投票人ID在字典中的编号（从0开始连续分配）
+typedef uint32_t VoterHandle;
+
+/**
+ * 投票人ID字典（字符串驻留）
+ * 每个投票人ID只保存一份，映射为32位句柄；话题的投票人状态与投票历史只记录句柄，
+ * 同一投票人再次投票时可直接使用句柄，不必重新哈希字符串。
+ * 句柄在字典清空前保持不变。
+ * 全部ID按句柄顺序首尾相接存放在一块连续内存中，查找索引为只存句柄的开放寻址表，
+ * 整个字典由几个平坦数组组成，快照载入时整块复制即可，无需逐个重新登记。
+ */
+class VoterDictionary {
+public:
+    static const VoterHandle kNoVoter = UINT32_MAX;
+
+    VoterDictionary();
+
+    /**
+     * 登记投票人ID（已存在时返回原句柄）
+     * @param voterId 投票人ID（调用方负责去除首尾空白）
+     * @return 句柄
+     */
+    VoterHandle intern(const std::string &voterId);
+
+    /**
+     * 查找投票人ID
+     * @return 句柄，未登记时返回 kNoVoter
+     */
+    VoterHandle find(const std::string &voterId) const;
+
+    bool contains(VoterHandle handle) const { return handle < hashes.size(); }
+
+    /**
+     * 句柄对应的投票人ID（句柄必须有效）
+     */
+    std::string idOf(VoterHandle handle) const { return std::string(idData(handle), idLength(handle)); }
+    // 句柄对应ID的首字节与长度（不复制；字典再次登记新ID后可能失效）
+    const char* idData(VoterHandle handle) const { return text.data() + offsets[handle]; }
+    size_t idLength(VoterHandle handle) const { return static_cast<size_t>(offsets[handle + 1] - offsets[handle]); }
+
+    void reserve(size_t n);
+    void clear();
+
+    size_t size() const { return hashes.size(); }
+
+    /**
+     * 快照：依次保存ID文本、偏移、哈希值与索引四个数组
+     */
+    void saveSnapshot(SnapshotWriter &out) const;
+    /**
+     * 从快照载入（替换现有内容），各数组整块复制，不重新哈希
+     * @return true表示成功，false表示数据不一致（此时字典为空）
+     */
+    bool loadSnapshot(SnapshotReader &in);
+
+private:
+    std::string text;                   // 全部ID按句柄顺序首尾相接
+    std::vector<uint64_t> offsets;      // 句柄 h 的ID为 text[offsets[h], offsets[h+1])；offsets[0] = 0
+    std::vector<uint32_t> hashes;       // 各ID的哈希值，扩容与比较时不必重新读取字符串
+    std::vector<uint32_t> slots;        // 线性探测索引：句柄+1，0表示空；容量为2的幂
+
+    static uint32_t hashOf(const char *data, size_t size);
+    // 查找ID所在槽位；不存在时返回应插入的空槽位
+    size_t probe(const char *data, size_t size, uint32_t hash) const;
+    void rehash(size_t capacity);
+};
+
+#endif // VOTER_DICTIONARY_H
@@ -0,0 +1,314 @@
+#include "../include/ballot_table.h"
+#include "../include/snapshot_file.h"
+
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ELECTION_HAVE_SSE2_PROBE 1
+#include <emmintrin.h>
+#endif
+
+// ==================== 扁平投票人状态表实现 ====================
+
+namespace {
+
+const size_t kGroupSize = 16;
+const int8_t kEmpty = -128;    // 0x80：从未使用
+const int8_t kDeleted = -2;    // 0xFE：已删除（墓碑），查找时需越过
+// 有效记录与墓碑合计不超过容量的 7/8
+const size_t kMaxLoadNum = 7;
+const size_t kMaxLoadDen = 8;
+const size_t npos = static_cast<size_t>(-1);
+
+// 64位混合函数（MurmurHash3 finalizer），使话题ID与投票人句柄的每一位都影响组号与标签
+inline uint64_t mixHash(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline int8_t tagOf(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+inline size_t groupOf(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+
+inline unsigned lowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned i = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+// 组内控制字节等于 tag 的槽位掩码
+inline uint32_t matchTag(const int8_t *group, int8_t tag) {
+#ifdef ELECTION_HAVE_SSE2_PROBE
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+        if (group[i] == tag) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+inline uint32_t matchEmpty(const int8_t *group) {
+    return matchTag(group, kEmpty);
+}
+
+// 空槽与墓碑的最高位为1，有效槽（标签 0..127）为0
+inline uint32_t matchEmptyOrDeleted(const int8_t *group) {
+#ifdef ELECTION_HAVE_SSE2_PROBE
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+        if (group[i] < 0) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+} // namespace
+
+BallotTable::BallotTable() : count(0), tombstones(0), groupMask(0) {}
+
+// 按组做三角数探测（g, g+1, g+3, g+6, ...），组数为2的幂时可遍历全部组；
+// 某组中存在空槽说明键不可能被放到更后面的组，查找到此为止
+size_t BallotTable::findSlot(uint64_t key, uint64_t hash) const {
+    if (ctrl.empty()) {
+        return npos;
+    }
+    int8_t tag = tagOf(hash);
+    size_t group = groupOf(hash) & groupMask;
+    for (size_t step = 0; step <= groupMask; step++) {
+        const int8_t *g = ctrl.data() + group * kGroupSize;
+        for (uint32_t m = matchTag(g, tag); m != 0; m &= m - 1) {
+            size_t index = group * kGroupSize + lowestBit(m);
+            if (slots[index].key == key) {
+                return index;
+            }
+        }
+        if (matchEmpty(g) != 0) {
+            return npos;
+        }
+        group = (group + step + 1) & groupMask;
+    }
+    return npos;
+}
+
+size_t BallotTable::findInsertSlot(uint64_t hash) const {
+    size_t group = groupOf(hash) & groupMask;
+    for (size_t step = 0; step <= groupMask; step++) {
+        uint32_t m = matchEmptyOrDeleted(ctrl.data() + group * kGroupSize);
+        if (m != 0) {
+            return group * kGroupSize + lowestBit(m);
+        }
+        group = (group + step + 1) & groupMask;
+    }
+    return npos; // 负载上限保证不会到达
+}
+
+BallotState* BallotTable::find(int topicId, VoterHandle voter) {
+    uint64_t key = makeKey(topicId, voter);
+    size_t index = findSlot(key, mixHash(key));
+    return index == npos ? nullptr : &slots[index].ballot;
+}
+
+const BallotState* BallotTable::find(int topicId, VoterHandle voter) const {
+    uint64_t key = makeKey(topicId, voter);
+    size_t index = findSlot(key, mixHash(key));
+    return index == npos ? nullptr : &slots[index].ballot;
+}
+
+BallotState& BallotTable::findOrInsert(int topicId, VoterHandle voter) {
+    uint64_t key = makeKey(topicId, voter);
+    uint64_t hash = mixHash(key);
+    size_t index = findSlot(key, hash);
+    if (index != npos) {
+        return slots[index].ballot;
+    }
+
+    size_t capacity = ctrl.size();
+    if ((count + tombstones + 1) * kMaxLoadDen > capacity * kMaxLoadNum) {
+        // 墓碑较多时原尺寸重建即可回收，否则容量翻倍
+        size_t groups = capacity / kGroupSize;
+        if (groups == 0) {
+            groups = 1;
+        } else if ((count + 1) * kMaxLoadDen * 2 > capacity * kMaxLoadNum) {
+            groups *= 2;
+        }
+        rehash(groups);
+    }
+
+    index = findInsertSlot(hash);
+    if (ctrl[index] == kDeleted) {
+        tombstones--;
+    }
+    ctrl[index] = tagOf(hash);
+    slots[index].key = key;
+    count++;
+    return slots[index].ballot;
+}
+
+void BallotTable::eraseAt(size_t index) {
+    slots[index].ballot = BallotState();
+    // 所在组仍有空槽时，没有键会因这一组满而被放到后面的组，可直接标为空槽
+    const int8_t *g = ctrl.data() + (index / kGroupSize) * kGroupSize;
+    if (matchEmpty(g) != 0) {
+        ctrl[index] = kEmpty;
+    } else {
+        ctrl[index] = kDeleted;
+        tombstones++;
+    }
+    count--;
+}
+
+bool BallotTable::erase(int topicId, VoterHandle voter) {
+    uint64_t key = makeKey(topicId, voter);
+    size_t index = findSlot(key, mixHash(key));
+    if (index == npos) {
+        return false;
+    }
+    eraseAt(index);
+    return true;
+}
+
+void BallotTable::reserve(size_t n) {
+    size_t needed = (n * kMaxLoadDen + kMaxLoadNum - 1) / kMaxLoadNum;
+    size_t groups = 1;
+    while (groups * kGroupSize < needed) {
+        groups *= 2;
+    }
+    if (groups * kGroupSize > ctrl.size()) {
+        rehash(groups);
+    }
+}
+
+void BallotTable::clear() {
+    std::vector<int8_t>().swap(ctrl);
+    std::vector<Slot>().swap(slots);
+    count = 0;
+    tombstones = 0;
+    groupMask = 0;
+}
+
+void BallotTable::rehash(size_t groupCount) {
+    std::vector<int8_t> oldCtrl(groupCount * kGroupSize, kEmpty);
+    std::vector<Slot> oldSlots(groupCount * kGroupSize);
+    oldCtrl.swap(ctrl);
+    oldSlots.swap(slots);
+    groupMask = groupCount - 1;
+    tombstones = 0;
+    for (size_t i = 0; i < oldCtrl.size(); i++) {
+        if (oldCtrl[i] < 0) {
+            continue;
+        }
+        uint64_t hash = mixHash(oldSlots[i].key);
+        size_t index = findInsertSlot(hash);
+        ctrl[index] = tagOf(hash);
+        slots[index].key = oldSlots[i].key;
+        slots[index].ballot = std::move(oldSlots[i].ballot);
+    }
+}
+
+// 布局：记录数、墓碑数、控制字节、键、内联位图，以及溢出选项 [槽位, 个数, 下标...] 的扁平数组
+void BallotTable::saveSnapshot(SnapshotWriter &out) const {
+    out.writeValue<uint64_t>(count);
+    out.writeValue<uint64_t>(tombstones);
+    out.writeArray(ctrl);
+
+    std::vector<uint64_t> keys(slots.size(), 0);
+    std::vector<uint64_t> bits(slots.size(), 0);
+    std::vector<uint32_t> overflow;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (ctrl[i] < 0) {
+            continue;
+        }
+        keys[i] = slots[i].key;
+        bits[i] = slots[i].ballot.inlineBits();
+        const std::vector<uint32_t> *large = slots[i].ballot.overflowSlots();
+        if (large) {
+            overflow.push_back(static_cast<uint32_t>(i));
+            overflow.push_back(static_cast<uint32_t>(large->size()));
+            overflow.insert(overflow.end(), large->begin(), large->end());
+        }
+    }
+    out.writeArray(keys);
+    out.writeArray(bits);
+    out.writeArray(overflow);
+}
+
+bool BallotTable::loadSnapshot(SnapshotReader &in, size_t voterCount) {
+    clear();
+    uint64_t savedCount = 0;
+    uint64_t savedTombstones = 0;
+    uint64_t capacity = 0;
+    uint64_t keyCount = 0;
+    uint64_t bitCount = 0;
+    uint64_t overflowCount = 0;
+    in.readValue(savedCount);
+    in.readValue(savedTombstones);
+    const int8_t *ctrlData = in.readArray<int8_t>(capacity);
+    const uint64_t *keys = in.readArray<uint64_t>(keyCount);
+    const uint64_t *bits = in.readArray<uint64_t>(bitCount);
+    const uint32_t *overflow = in.readArray<uint32_t>(overflowCount);
+    if (!in.good() || keyCount != capacity || bitCount != capacity ||
+        capacity % kGroupSize != 0 || ((capacity / kGroupSize) & (capacity / kGroupSize - 1)) != 0) {
+        return false;
+    }
+    if (capacity == 0) {
+        return savedCount == 0;
+    }
+
+    ctrl.assign(ctrlData, ctrlData + capacity);
+    slots.resize(capacity);
+    size_t live = 0;
+    size_t deleted = 0;
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] >= 0) {
+            if ((keys[i] & 0xFFFFFFFFu) >= voterCount) {
+                clear();
+                return false;
+            }
+            slots[i].key = keys[i];
+            slots[i].ballot = BallotState(bits[i]);
+            live++;
+        } else if (ctrl[i] == kDeleted) {
+            deleted++;
+        } else if (ctrl[i] != kEmpty) {
+            clear();
+            return false;
+        }
+    }
+    for (uint64_t pos = 0; pos + 2 <= overflowCount; ) {
+        uint32_t index = overflow[pos];
+        uint32_t n = overflow[pos + 1];
+        pos += 2;
+        if (index >= capacity || ctrl[index] < 0 || n > overflowCount - pos) {
+            clear();
+            return false;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            slots[index].ballot.insert(overflow[pos + k]);
+        }
+        pos += n;
+    }
+    if (live != savedCount || deleted != savedTombstones) {
+        clear();
+        return false;
+    }
+    count = live;
+    tombstones = deleted;
+    groupMask = capacity / kGroupSize - 1;
+    return true;
+}
@@ -0,0 +1,940 @@
+#include "../include/election_core.h"
+#include "../include/vote_histogram.h"
+#include "../include/vote_parser.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+
+// ==================== 微基准测试：ElectionSystem 热点路径 ====================
+//
+// 每个用例在 10, 100, ..., max-size 的规模上扫描；每个规模先预热若干次，
+// 再重复测量，输出最小值/中位数/均值/标准差/P95 以及吞吐量。
+// 建议使用 Release 构建（-DCMAKE_BUILD_TYPE=Release）运行。
+//
+// 用法示例：
+//   election_bench --max-size 1000000 --reps 10 --json bench.json
+//   election_bench --filter vote --min-size 1000 --max-size 100000000
+
+namespace {
+
+struct BenchConfig {
+    size_t minSize;
+    size_t maxSize;
+    int reps;
+    int warmup;
+    double budgetSeconds;   // 单个（用例, 规模）的时间预算，超出后提前结束重复
+    string filter;
+    string jsonPath;
+    string tmpDir;
+
+    BenchConfig()
+        : minSize(10), maxSize(1000000), reps(7), warmup(2),
+          budgetSeconds(10.0), filter(""), jsonPath(""), tmpDir("") {}
+};
+
+struct BenchResult {
+    string name;
+    size_t size;
+    int reps;
+    double minNs;
+    double medianNs;
+    double meanNs;
+    double stddevNs;
+    double p95Ns;
+    double itemsPerSec;
+};
+
+// 防止编译器消除被测代码
+volatile long long g_sink = 0;
+
+/**
+ * 计时执行器
+ * 每次重复先执行 setup（不计时），再执行 body（计时）
+ */
+class Runner {
+public:
+    Runner(const BenchConfig &config) : config_(config) {}
+
+    void measure(const std::function<void()> &setup, const std::function<void()> &body) {
+        samples_.clear();
+        for (int i = 0; i < config_.warmup; ++i) {
+            setup();
+            body();
+        }
+
+        auto budgetStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < config_.reps; ++i) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            samples_.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+            double spent = std::chrono::duration<double>(end - budgetStart).count();
+            if (spent > config_.budgetSeconds) {
+                break;
+            }
+        }
+    }
+
+    const vector<double>& samples() const { return samples_; }
+    const BenchConfig& config() const { return config_; }
+
+private:
+    const BenchConfig &config_;
+    vector<double> samples_;
+};
+
+struct BenchCase {
+    string name;
+    size_t sizeLimit;   // 该用例可承受的最大规模（0 表示不限）
+    std::function<void(size_t n, Runner &runner)> run;
+};
+
+// ==================== 测试数据生成 ====================
+
+string makeAsciiName(size_t i) {
+    string name = "Cand";
+    do {
+        name.push_back(static_cast<char>('a' + i % 26));
+        i /= 26;
+    } while (i > 0);
+    return name;
+}
+
+string makeMixedName(size_t i) {
+    static const char *surnames[] = {"张", "王", "李", "赵", "刘", "陈", "杨", "黄", "周", "吴"};
+    static const char *givens[] = {"伟", "芳", "娜", "敏", "静", "强", "磊", "军", "洋", "勇"};
+    if (i % 2 == 0) {
+        return makeAsciiName(i);
+    }
+    string name = surnames[i % 10];
+    name += givens[(i / 10) % 10];
+    name += givens[(i / 100) % 10];
+    return name;
+}
+
+void populateCandidates(ElectionSystem &system, size_t n, int idStride = 1) {
+    for (size_t i = 0; i < n; ++i) {
+        system.addCandidate(static_cast<int>(i) * idStride + 1, makeAsciiName(i), "Dept");
+    }
+}
+
+vector<Candidate> makeCandidateVector(size_t n, bool mixedNames) {
+    vector<Candidate> out;
+    out.reserve(n);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < n; ++i) {
+        Candidate c(static_cast<int>(i + 1), mixedNames ? makeMixedName(rng() % (n * 4 + 1)) : makeAsciiName(i), "Dept");
+        c.voteCount = static_cast<int>(rng() % 1000);
+        out.push_back(c);
+    }
+    return out;
+}
+
+vector<int> makeBallots(size_t n, int candidateCount, double invalidRatio = 0.0) {
+    vector<int> votes(n);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(1, candidateCount);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        votes[i] = (invalidRatio > 0.0 && coin(rng) < invalidRatio) ? -1 : pick(rng);
+    }
+    return votes;
+}
+
+vector<string> makeVoterIds(size_t n) {
+    vector<string> ids;
+    ids.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        ids.push_back("voter_" + std::to_string(i));
+    }
+    return ids;
+}
+
+int createBenchTopic(ElectionSystem &system, int optionCount, int votesPerVoter) {
+    vector<string> optionTexts;
+    for (int i = 0; i < optionCount; ++i) {
+        optionTexts.push_back("option " + std::to_string(i + 1));
+    }
+    return system.createTopic("bench topic", "benchmark", optionTexts, votesPerVoter);
+}
+
+// 在 topicCount 个话题中投 n 票（每个投票人在一个话题中投满8票），返回话题ID
+vector<int> castSpreadTopicVotes(ElectionSystem &system, size_t n, int topicCount) {
+    vector<int> topicIds;
+    for (int t = 0; t < topicCount; ++t) {
+        topicIds.push_back(createBenchTopic(system, 8, 8));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        VoterHandle voter = system.internVoter("voter_" + std::to_string(i / 8));
+        system.castTopicVote(topicIds[(i / 8) % topicCount], static_cast<int>(i % 8) + 1, voter);
+    }
+    return topicIds;
+}
+
+void makeTopicData(size_t records, vector<VoteTopic> &topics, vector<TopicVoteRecord> &history) {
+    ElectionSystem system;
+    int topicId = createBenchTopic(system, 8, 1);
+    topics = system.getAllTopics();
+    history.clear();
+    history.reserve(records);
+    for (size_t i = 0; i < records; ++i) {
+        int optionId = static_cast<int>(i % 8) + 1;
+        topics[0].options[optionId - 1].voteCount++;
+        history.push_back(TopicVoteRecord(topicId, "voter_" + std::to_string(i), optionId,
+                                          static_cast<time_t>(1700000000 + i)));
+    }
+}
+
+// ==================== 用例注册 ====================
+
+const int kBallotCandidates = 100;
+const size_t kRosterLimit = 1000000; // 需要构建完整候选人名单的用例上限
+
+void registerCases(vector<BenchCase> &cases, const BenchConfig &config) {
+    const string tmp = config.tmpDir;
+
+    cases.push_back({"ElectionSystem::vote", 0, [](size_t n, Runner &runner) {
+        vector<int> votes = makeBallots(n, kBallotCandidates);
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates);
+        runner.measure([&]() { system.resetVotes(); },
+                       [&]() { g_sink += system.vote(votes, false).validCount; });
+    }});
+
+    cases.push_back({"ElectionSystem::vote(1% invalid)", 0, [](size_t n, Runner &runner) {
+        vector<int> votes = makeBallots(n, kBallotCandidates, 0.01);
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates);
+        runner.measure([&]() { system.resetVotes(); },
+                       [&]() { g_sink += system.vote(votes, false).invalidCount; });
+    }});
+
+    cases.push_back({"ElectionSystem::vote(sparse ids)", 0, [](size_t n, Runner &runner) {
+        // 候选人ID间隔很大，索引退回哈希表
+        const int stride = 1000003;
+        vector<int> votes = makeBallots(n, kBallotCandidates);
+        for (int &v : votes) v = (v - 1) * stride + 1;
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates, stride);
+        runner.measure([&]() { system.resetVotes(); },
+                       [&]() { g_sink += system.vote(votes, false).validCount; });
+    }});
+
+    const unsigned threadCounts[] = {2, 4, 8};
+    for (unsigned threads : threadCounts) {
+        cases.push_back({"ElectionSystem::voteParallel(" + std::to_string(threads) + " threads)", 0,
+                         [threads](size_t n, Runner &runner) {
+            vector<int> votes = makeBallots(n, kBallotCandidates);
+            ElectionSystem system;
+            populateCandidates(system, kBallotCandidates);
+            runner.measure([&]() { system.resetVotes(); },
+                           [&]() { g_sink += system.voteParallel(votes, threads).validCount; });
+        }});
+    }
+
+    const VoteHistogram::Kernel kernels[] = {VoteHistogram::Kernel::Scalar, VoteHistogram::Kernel::Auto};
+    for (VoteHistogram::Kernel kernel : kernels) {
+        string label = kernel == VoteHistogram::Kernel::Scalar ? "scalar" : "auto";
+        cases.push_back({"VoteHistogram::count(" + label + ")", 0, [kernel](size_t n, Runner &runner) {
+            vector<int> votes = makeBallots(n, kBallotCandidates);
+            vector<uint64_t> counts(kBallotCandidates);
+            VoteHistogram::setKernel(kernel);
+            runner.measure([]() {}, [&]() {
+                g_sink += VoteHistogram::count(votes.data(), votes.size(), 1, counts.size(), counts.data());
+            });
+            VoteHistogram::setKernel(VoteHistogram::Kernel::Auto);
+        }});
+    }
+
+    cases.push_back({"ElectionSystem::castVote", 0, [](size_t n, Runner &runner) {
+        vector<int> votes = makeBallots(n, kBallotCandidates);
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates);
+        runner.measure([&]() { system.resetVotes(); },
+                       [&]() {
+                           long long ok = 0;
+                           for (int v : votes) ok += system.castVote(v);
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::findWinner", kRosterLimit, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        populateCandidates(system, n);
+        vector<int> votes = makeBallots(n * 4, static_cast<int>(n));
+        system.vote(votes, false);
+        runner.measure([]() {}, [&]() { g_sink += system.findWinner(); });
+    }});
+
+    cases.push_back({"ElectionSystem::getCandidatesByVotes(top10)", kRosterLimit, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        populateCandidates(system, n);
+        vector<int> votes = makeBallots(n * 4, static_cast<int>(n));
+        system.vote(votes, false);
+        runner.measure([]() {}, [&]() { g_sink += system.getCandidatesByVotes(10).front()->voteCount; });
+    }});
+
+    cases.push_back({"ElectionSystem::getCandidateRank", kRosterLimit, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        populateCandidates(system, n);
+        vector<int> votes = makeBallots(n * 4, static_cast<int>(n));
+        system.vote(votes, false);
+        runner.measure([]() {}, [&]() {
+            long long ranks = 0;
+            for (size_t id = 1; id <= n; ++id) ranks += system.getCandidateRank(static_cast<int>(id));
+            g_sink += ranks;
+        });
+    }});
+
+    cases.push_back({"ElectionSystem::addCandidate", kRosterLimit, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        runner.measure([&]() { system.clearAll(); },
+                       [&]() {
+                           populateCandidates(system, n);
+                           g_sink += system.queryCandidate(static_cast<int>(n)) != nullptr;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::addCandidates", kRosterLimit, [](size_t n, Runner &runner) {
+        vector<Candidate> rows = makeCandidateVector(n, false);
+        ElectionSystem system;
+        runner.measure([&]() { system.clearAll(); },
+                       [&]() { g_sink += system.addCandidates(rows); });
+    }});
+
+    cases.push_back({"ElectionSystem::deleteCandidate", kRosterLimit, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        runner.measure([&]() { system.clearAll(); populateCandidates(system, n); },
+                       [&]() {
+                           long long ok = 0;
+                           for (size_t i = 0; i < n; ++i) ok += system.deleteCandidate(static_cast<int>(i) + 1);
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::undoLastVotes", 0, [](size_t n, Runner &runner) {
+        vector<int> votes = makeBallots(n, kBallotCandidates);
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates);
+        runner.measure([&]() { system.resetVotes(); system.vote(votes, false); },
+                       [&]() { g_sink += system.undoLastVotes(static_cast<int>(n)); });
+    }});
+
+    cases.push_back({"ElectionSystem::castTopicVote", 0, [](size_t n, Runner &runner) {
+        vector<string> voters = makeVoterIds(n);
+        ElectionSystem system;
+        int topicId = -1;
+        runner.measure([&]() { system.clearAll(); topicId = createBenchTopic(system, 8, 1); },
+                       [&]() {
+                           long long ok = 0;
+                           for (size_t i = 0; i < n; ++i) {
+                               ok += system.castTopicVote(topicId, static_cast<int>(i % 8) + 1, voters[i]);
+                           }
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::castTopicVote(voter handle)", 0, [](size_t n, Runner &runner) {
+        // 投票人已登记（例如前端会话中缓存了句柄）：不再哈希ID字符串
+        vector<string> voters = makeVoterIds(n);
+        vector<VoterHandle> handles(n);
+        ElectionSystem system;
+        int topicId = -1;
+        runner.measure([&]() {
+                           system.clearAll();
+                           topicId = createBenchTopic(system, 8, 1);
+                           for (size_t i = 0; i < n; ++i) handles[i] = system.internVoter(voters[i]);
+                       },
+                       [&]() {
+                           long long ok = 0;
+                           for (size_t i = 0; i < n; ++i) {
+                               ok += system.castTopicVote(topicId, static_cast<int>(i % 8) + 1, handles[i]);
+                           }
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::castTopicVote(repeat voters, 2 topics)", 0, [](size_t n, Runner &runner) {
+        // 投票人随机重复出现在两个话题中（每人每话题2票），去重查找命中已有记录
+        vector<string> voters = makeVoterIds(n);
+        vector<size_t> order(n);
+        std::mt19937 rng(17);
+        for (size_t i = 0; i < n; ++i) order[i] = rng() % n;
+        vector<VoterHandle> handles(n);
+        ElectionSystem system;
+        int topics[2] = {-1, -1};
+        runner.measure([&]() {
+                           system.clearAll();
+                           topics[0] = createBenchTopic(system, 8, 2);
+                           topics[1] = createBenchTopic(system, 8, 2);
+                           for (size_t i = 0; i < n; ++i) handles[i] = system.internVoter(voters[i]);
+                           system.reserveVoters(n, 2 * n);
+                       },
+                       [&]() {
+                           long long ok = 0;
+                           for (size_t i = 0; i < n; ++i) {
+                               ok += system.castTopicVote(topics[i & 1], static_cast<int>(i % 8) + 1, handles[order[i]]);
+                           }
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::castTopicVote(4096 imported options)", 0, [](size_t n, Runner &runner) {
+        // 导入的话题选项ID不一定从1连续编号：按选项索引查找
+        const int optionCount = 4096;
+        VoteTopic imported;
+        imported.title = "imported topic";
+        for (int i = 0; i < optionCount; ++i) {
+            imported.options.push_back(VoteOption(1000 + i * 3, "option " + std::to_string(i + 1)));
+        }
+        vector<int> optionIds;
+        optionIds.reserve(n);
+        std::mt19937 rng(13);
+        for (size_t i = 0; i < n; ++i) {
+            optionIds.push_back(1000 + static_cast<int>(rng() % optionCount) * 3);
+        }
+        ElectionSystem system;
+        runner.measure([&]() { system.clearAll(); system.importTopic(imported, vector<TopicVoteRecord>(), 1); },
+                       [&]() {
+                           long long ok = 0;
+                           for (int optionId : optionIds) ok += system.castTopicVote(1, optionId);
+                           g_sink += ok;
+                       });
+    }});
+
+    cases.push_back({"ElectionSystem::getTopicVoteHistory(1 of 64 topics)", 0, [](size_t n, Runner &runner) {
+        // 导出单个话题：只遍历该话题的历史
+        ElectionSystem system;
+        vector<int> topicIds = castSpreadTopicVotes(system, n, 64);
+        runner.measure([]() {}, [&]() { g_sink += system.getTopicVoteHistory(topicIds[0]).size(); });
+    }});
+
+    cases.push_back({"ElectionSystem::deleteTopic(1 of 64 topics)", 0, [](size_t n, Runner &runner) {
+        ElectionSystem system;
+        vector<int> topicIds;
+        runner.measure([&]() { system.clearAll(); topicIds = castSpreadTopicVotes(system, n, 64); },
+                       [&]() { g_sink += system.deleteTopic(topicIds[0]); });
+    }});
+
+    const bool compressedLog[] = {false, true};
+    for (bool compressed : compressedLog) {
+        string label = compressed ? "(compressed)" : "";
+        cases.push_back({"TopicVoteLog::append" + label, 0, [compressed](size_t n, Runner &runner) {
+            TopicVoteLog log;
+            runner.measure([&]() { log.clear(); log.setCompression(compressed); },
+                           [&]() {
+                               for (size_t i = 0; i < n; ++i) {
+                                   log.append(TopicVoteEntry(static_cast<int>(i % 3) + 1, static_cast<VoterHandle>(i),
+                                                             static_cast<int>(i % 8) + 1, static_cast<time_t>(1700000000 + i / 16), i));
+                               }
+                               g_sink += log.size();
+                           });
+        }});
+
+        cases.push_back({"TopicVoteLog::forEach" + label, 0, [compressed](size_t n, Runner &runner) {
+            TopicVoteLog log;
+            log.setCompression(compressed);
+            for (size_t i = 0; i < n; ++i) {
+                log.append(TopicVoteEntry(static_cast<int>(i % 3) + 1, static_cast<VoterHandle>(i),
+                                          static_cast<int>(i % 8) + 1, static_cast<time_t>(1700000000 + i / 16), i));
+            }
+            runner.measure([]() {}, [&]() {
+                long long sum = 0;
+                log.forEach([&](const TopicVoteEntry &e) { sum += e.optionId; });
+                g_sink += sum;
+            });
+        }});
+    }
+
+    cases.push_back({"ElectionSystem::getTopicRemainingVotes", 0, [](size_t n, Runner &runner) {
+        vector<string> voters = makeVoterIds(n);
+        ElectionSystem system;
+        int topicId = createBenchTopic(system, 8, 3);
+        for (size_t i = 0; i < n; i += 2) {
+            system.castTopicVote(topicId, static_cast<int>(i % 8) + 1, voters[i]);
+        }
+        runner.measure([]() {}, [&]() {
+            long long remain = 0;
+            for (size_t i = 0; i < n; ++i) {
+                remain += system.getTopicRemainingVotes(topicId, voters[i]);
+            }
+            g_sink += remain;
+        });
+    }});
+
+    cases.push_back({"NameCollation::sortKey", 0, [](size_t n, Runner &runner) {
+        vector<Candidate> source = makeCandidateVector(n, true);
+        runner.measure([]() {}, [&]() {
+            size_t bytes = 0;
+            for (const auto &c : source) bytes += NameCollation::sortKey(c.name).size();
+            g_sink += static_cast<long long>(bytes);
+        });
+    }});
+
+    cases.push_back({"Statistics::sortByName", 0, [](size_t n, Runner &runner) {
+        vector<Candidate> source = makeCandidateVector(n, true);
+        // 与 ElectionSystem 一致：排序键在添加候选人时生成并缓存
+        for (auto &c : source) c.sortKey = NameCollation::sortKey(c.name);
+        vector<Candidate> work;
+        runner.measure([&]() { work = source; },
+                       [&]() { Statistics::sortByName(work); g_sink += work.front().id; });
+    }});
+
+    // ---------- FileManager 读写 ----------
+
+    const char *voteFormats[] = {"csv", "txt"};
+    for (const char *fmt : voteFormats) {
+        string path = tmp + "/election_bench_votes." + fmt;
+        cases.push_back({string("FileManager::saveVotes(") + fmt + ")", 0, [path](size_t n, Runner &runner) {
+            vector<int> votes = makeBallots(n, kBallotCandidates);
+            runner.measure([]() {}, [&]() { g_sink += FileManager::saveVotes(votes, path); });
+            std::remove(path.c_str());
+        }});
+        cases.push_back({string("FileManager::loadVotes(") + fmt + ")", 0, [path](size_t n, Runner &runner) {
+            FileManager::saveVotes(makeBallots(n, kBallotCandidates), path);
+            vector<int> votes;
+            runner.measure([]() {}, [&]() { g_sink += FileManager::loadVotes(votes, path); });
+            std::remove(path.c_str());
+        }});
+        bool textFormat = string(fmt) == "txt";
+        cases.push_back({string("FileManager::loadVotes(") + fmt + ", istream)", 0, [path, textFormat](size_t n, Runner &runner) {
+            FileManager::saveVotes(makeBallots(n, kBallotCandidates), path);
+            vector<int> votes;
+            runner.measure([]() {}, [&]() {
+                ifstream in(path);
+                g_sink += FileManager::loadVotes(votes, in, textFormat);
+            });
+            std::remove(path.c_str());
+        }});
+        // 对比：先载入整个投票向量再计票 vs 边读边计票（不保留历史）
+        cases.push_back({string("loadVotes + ElectionSystem::vote(") + fmt + ")", 0, [path](size_t n, Runner &runner) {
+            FileManager::saveVotes(makeBallots(n, kBallotCandidates), path);
+            ElectionSystem system;
+            populateCandidates(system, kBallotCandidates);
+            vector<int> votes;
+            runner.measure([&]() { system.resetVotes(); }, [&]() {
+                FileManager::loadVotes(votes, path);
+                g_sink += system.vote(votes, false).validCount;
+            });
+            std::remove(path.c_str());
+        }});
+        cases.push_back({string("ElectionSystem::importVotes(") + fmt + ", no history)", 0, [path](size_t n, Runner &runner) {
+            FileManager::saveVotes(makeBallots(n, kBallotCandidates), path);
+            ElectionSystem system;
+            populateCandidates(system, kBallotCandidates);
+            system.setVoteHistoryRetention(VoteHistoryRetention::None);
+            runner.measure([&]() { system.resetVotes(); }, [&]() {
+                VoteTallyResult tally;
+                system.importVotes(path, tally);
+                g_sink += tally.validCount;
+            });
+            std::remove(path.c_str());
+        }});
+        // 纯解析吞吐：数据已在内存中，边解析边累加，不生成投票数组
+        cases.push_back({string("VoteParser::parse(") + fmt + ")", 0, [textFormat](size_t n, Runner &runner) {
+            std::ostringstream out;
+            for (int v : makeBallots(n, kBallotCandidates)) out << v << (textFormat ? ' ' : '\n');
+            string data = out.str();
+            runner.measure([]() {}, [&]() {
+                long long sum = 0;
+                VoteParser::parse(data.data(), data.size(), textFormat, [&sum](int v) { sum += v; });
+                g_sink += sum;
+            });
+        }});
+    }
+
+    const char *candidateFormats[] = {"csv", "txt"};
+    for (const char *fmt : candidateFormats) {
+        string path = tmp + "/election_bench_candidates." + fmt;
+        cases.push_back({string("FileManager::saveCandidates(") + fmt + ")", 0, [path](size_t n, Runner &runner) {
+            vector<Candidate> candidates = makeCandidateVector(n, false);
+            runner.measure([]() {}, [&]() { g_sink += FileManager::saveCandidates(candidates, path); });
+            std::remove(path.c_str());
+        }});
+        cases.push_back({string("FileManager::loadCandidates(") + fmt + ")", 0, [path](size_t n, Runner &runner) {
+            FileManager::saveCandidates(makeCandidateVector(n, false), path);
+            vector<Candidate> candidates;
+            runner.measure([]() {}, [&]() { g_sink += FileManager::loadCandidates(candidates, path); });
+            std::remove(path.c_str());
+        }});
+    }
+
+    string streamPath = tmp + "/election_bench_stream_votes.csv";
+    cases.push_back({"ElectionSystem::findWinnerStreaming", 0, [streamPath](size_t n, Runner &runner) {
+        vector<int> votes = makeBallots(n, kBallotCandidates);
+        for (size_t i = 0; i < n; i += 2) votes[i] = 1;   // 制造一个过半的候选人
+        FileManager::saveVotes(votes, streamPath);
+        ElectionSystem system;
+        populateCandidates(system, kBallotCandidates);
+        runner.measure([]() {}, [&]() {
+            StreamingWinnerResult result;
+            system.findWinnerStreaming(streamPath, result);
+            g_sink += result.winnerID;
+        });
+        std::remove(streamPath.c_str());
+    }});
+
+    // ---------- 话题投票日志 ----------
+
+    string journalPath = tmp + "/election_bench_votes.journal";
+    cases.push_back({"ElectionSystem::castTopicVote(voter handle, journaled)", 0, [journalPath](size_t n, Runner &runner) {
+        // 与 castTopicVote(voter handle) 相同的投票，另写预写日志；计时包含最后一次 syncJournal
+        vector<string> voters = makeVoterIds(n);
+        vector<VoterHandle> handles(n);
+        ElectionSystem system;
+        int topicId = -1;
+        runner.measure([&]() {
+                           system.closeJournal();
+                           std::remove(journalPath.c_str());
+                           system.openJournal(journalPath);
+                           topicId = createBenchTopic(system, 8, 1);
+                           for (size_t i = 0; i < n; ++i) handles[i] = system.internVoter(voters[i]);
+                           system.syncJournal();
+                       },
+                       [&]() {
+                           long long ok = 0;
+                           for (size_t i = 0; i < n; ++i) {
+                               ok += system.castTopicVote(topicId, static_cast<int>(i % 8) + 1, handles[i]);
+                           }
+                           g_sink += ok + system.syncJournal();
+                       });
+        system.closeJournal();
+        std::remove(journalPath.c_str());
+    }});
+
+    cases.push_back({"ElectionSystem::openJournal(replay)", 0, [journalPath](size_t n, Runner &runner) {
+        std::remove(journalPath.c_str());
+        {
+            ElectionSystem writer;
+            writer.openJournal(journalPath);
+            int topicId = createBenchTopic(writer, 8, 1);
+            for (size_t i = 0; i < n; ++i) {
+                writer.castTopicVote(topicId, static_cast<int>(i % 8) + 1, "voter_" + std::to_string(i));
+            }
+        }
+        ElectionSystem system;
+        runner.measure([&]() { system.closeJournal(); },
+                       [&]() { g_sink += system.openJournal(journalPath) + system.getTopicVoteCount(); });
+        system.closeJournal();
+        std::remove(journalPath.c_str());
+    }});
+
+    string reportPath = tmp + "/election_bench_report.txt";
+    cases.push_back({"FileManager::exportReport", 0, [reportPath](size_t n, Runner &runner) {
+        vector<Candidate> candidates = makeCandidateVector(n, false);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::exportReport(candidates, 1, reportPath); });
+        std::remove(reportPath.c_str());
+    }});
+
+    string topicsPath = tmp + "/election_bench_topics_data.csv";
+    cases.push_back({"FileManager::exportTopicsData", 0, [topicsPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::exportTopicsData(topics, history, topicsPath); });
+        std::remove(topicsPath.c_str());
+    }});
+    cases.push_back({"FileManager::exportTopicsData(O_DIRECT)", 0, [topicsPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        FileManager::setDirectOutput(true);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::exportTopicsData(topics, history, topicsPath); });
+        FileManager::setDirectOutput(false);
+        std::remove(topicsPath.c_str());
+    }});
+    cases.push_back({"FileManager::importTopicsData", 0, [topicsPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        FileManager::exportTopicsData(topics, history, topicsPath);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::importTopicsData(topics, history, topicsPath); });
+        std::remove(topicsPath.c_str());
+    }});
+    cases.push_back({"FileManager::importTopicsData(1 thread)", 0, [topicsPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        FileManager::exportTopicsData(topics, history, topicsPath);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::importTopicsData(topics, history, topicsPath, 1); });
+        std::remove(topicsPath.c_str());
+    }});
+
+    cases.push_back({"ElectionSystem::loadTopicsData(csv)", 0, [topicsPath](size_t n, Runner &runner) {
+        // 重启时从 CSV 恢复：解析 + 重建，作为快照载入的对照
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        FileManager::exportTopicsData(topics, history, topicsPath);
+        ElectionSystem system;
+        runner.measure([]() {}, [&]() {
+            vector<VoteTopic> loadedTopics;
+            vector<TopicVoteRecord> loadedHistory;
+            FileManager::importTopicsData(loadedTopics, loadedHistory, topicsPath);
+            g_sink += system.loadTopicsData(loadedTopics, loadedHistory);
+        });
+        std::remove(topicsPath.c_str());
+    }});
+
+    string snapshotPath = tmp + "/election_bench_topics.snapshot";
+    cases.push_back({"ElectionSystem::saveSnapshot", 0, [snapshotPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        ElectionSystem system;
+        system.loadTopicsData(topics, history);
+        runner.measure([]() {}, [&]() { g_sink += system.saveSnapshot(snapshotPath); });
+        std::remove(snapshotPath.c_str());
+    }});
+    cases.push_back({"ElectionSystem::loadSnapshot", 0, [snapshotPath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        {
+            ElectionSystem writer;
+            writer.loadTopicsData(topics, history);
+            writer.saveSnapshot(snapshotPath);
+        }
+        ElectionSystem system;
+        runner.measure([]() {}, [&]() { g_sink += system.loadSnapshot(snapshotPath); });
+        std::remove(snapshotPath.c_str());
+    }});
+
+    string singlePath = tmp + "/election_bench_topic_data.csv";
+    cases.push_back({"FileManager::exportSingleTopicData", 0, [singlePath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        runner.measure([]() {}, [&]() { g_sink += FileManager::exportSingleTopicData(topics[0], history, singlePath); });
+        std::remove(singlePath.c_str());
+    }});
+    cases.push_back({"FileManager::importSingleTopicData", 0, [singlePath](size_t n, Runner &runner) {
+        vector<VoteTopic> topics;
+        vector<TopicVoteRecord> history;
+        makeTopicData(n, topics, history);
+        FileManager::exportSingleTopicData(topics[0], history, singlePath);
+        VoteTopic topic;
+        runner.measure([]() {}, [&]() { g_sink += FileManager::importSingleTopicData(topic, history, singlePath); });
+        std::remove(singlePath.c_str());
+    }});
+}
+
+// ==================== 统计与输出 ====================
+
+BenchResult summarize(const string &name, size_t size, const vector<double> &samples) {
+    BenchResult r;
+    r.name = name;
+    r.size = size;
+    r.reps = static_cast<int>(samples.size());
+
+    vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t count = sorted.size();
+
+    double sum = 0.0;
+    for (double s : sorted) sum += s;
+    r.meanNs = sum / count;
+
+    double var = 0.0;
+    for (double s : sorted) var += (s - r.meanNs) * (s - r.meanNs);
+    r.stddevNs = count > 1 ? std::sqrt(var / (count - 1)) : 0.0;
+
+    r.minNs = sorted.front();
+    r.medianNs = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+    size_t p95Index = static_cast<size_t>(std::ceil(0.95 * count)) - 1;
+    r.p95Ns = sorted[std::min(p95Index, count - 1)];
+    r.itemsPerSec = r.medianNs > 0.0 ? size * 1e9 / r.medianNs : 0.0;
+    return r;
+}
+
+string formatDuration(double ns) {
+    std::ostringstream out;
+    out << fixed << setprecision(3);
+    if (ns < 1e3) out << ns << " ns";
+    else if (ns < 1e6) out << ns / 1e3 << " us";
+    else if (ns < 1e9) out << ns / 1e6 << " ms";
+    else out << ns / 1e9 << " s";
+    return out.str();
+}
+
+void printResult(const BenchResult &r) {
+    cout << left << setw(44) << r.name
+         << right << setw(11) << r.size
+         << setw(5) << r.reps
+         << setw(14) << formatDuration(r.minNs)
+         << setw(14) << formatDuration(r.medianNs)
+         << setw(14) << formatDuration(r.p95Ns)
+         << setw(10) << fixed << setprecision(1)
+         << (r.meanNs > 0.0 ? 100.0 * r.stddevNs / r.meanNs : 0.0) << "%"
+         << setw(16) << setprecision(0) << r.itemsPerSec << "\n";
+    cout.flush();
+}
+
+string jsonEscape(const string &s) {
+    string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') out.push_back('\\');
+        out.push_back(ch);
+    }
+    return out;
+}
+
+bool writeJson(const BenchConfig &config, const vector<BenchResult> &results, ostream &out) {
+    out << "{\n";
+    out << "  \"benchmark\": \"election_bench\",\n";
+    out << "  \"config\": {\"min_size\": " << config.minSize
+        << ", \"max_size\": " << config.maxSize
+        << ", \"reps\": " << config.reps
+        << ", \"warmup\": " << config.warmup
+        << ", \"budget_seconds\": " << config.budgetSeconds << "},\n";
+    out << "  \"results\": [\n";
+    out << setprecision(1) << fixed;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+            << ", \"size\": " << r.size
+            << ", \"reps\": " << r.reps
+            << ", \"min_ns\": " << r.minNs
+            << ", \"median_ns\": " << r.medianNs
+            << ", \"mean_ns\": " << r.meanNs
+            << ", \"stddev_ns\": " << r.stddevNs
+            << ", \"p95_ns\": " << r.p95Ns
+            << ", \"items_per_sec\": " << r.itemsPerSec << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+void printUsage(const char *prog) {
+    cerr << "用法: " << prog << " [选项]\n"
+         << "  --min-size N     最小规模（默认 10）\n"
+         << "  --max-size N     最大规模（默认 1000000，最大可设为 100000000）\n"
+         << "  --reps N         每个规模的测量次数（默认 7）\n"
+         << "  --warmup N       每个规模的预热次数（默认 2）\n"
+         << "  --budget S       单个规模的时间预算（秒，默认 10）\n"
+         << "  --filter TEXT    仅运行名称包含 TEXT 的用例\n"
+         << "  --json PATH      以 JSON 格式输出结果（PATH 为 - 时输出到标准输出）\n"
+         << "  --tmpdir DIR     文件读写用例使用的临时目录\n"
+         << "  --list           列出所有用例\n";
+}
+
+string defaultTmpDir() {
+    const char *env = std::getenv("TMPDIR");
+    if (env && *env) return env;
+#ifdef _WIN32
+    return ".";
+#else
+    return "/tmp";
+#endif
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    BenchConfig config;
+    config.tmpDir = defaultTmpDir();
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                cerr << "选项缺少参数: " << arg << "\n";
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--min-size") config.minSize = std::strtoull(next(), nullptr, 10);
+        else if (arg == "--max-size") config.maxSize = std::strtoull(next(), nullptr, 10);
+        else if (arg == "--reps") config.reps = std::atoi(next());
+        else if (arg == "--warmup") config.warmup = std::atoi(next());
+        else if (arg == "--budget") config.budgetSeconds = std::atof(next());
+        else if (arg == "--filter") config.filter = next();
+        else if (arg == "--json") config.jsonPath = next();
+        else if (arg == "--tmpdir") config.tmpDir = next();
+        else if (arg == "--list") listOnly = true;
+        else if (arg == "-h" || arg == "--help") { printUsage(argv[0]); return 0; }
+        else {
+            cerr << "未知选项: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.reps < 1 || config.minSize < 1 || config.maxSize < config.minSize) {
+        cerr << "参数无效\n";
+        return 1;
+    }
+
+    vector<BenchCase> cases;
+    registerCases(cases, config);
+
+    if (listOnly) {
+        for (const auto &c : cases) cout << c.name << "\n";
+        return 0;
+    }
+
+    // JSON 输出到标准输出时，表格输出改到标准错误
+    bool jsonToStdout = config.jsonPath == "-";
+    std::streambuf *tableBuf = cout.rdbuf();
+    if (jsonToStdout) cout.rdbuf(cerr.rdbuf());
+
+    cout << left << setw(44) << "case"
+         << right << setw(11) << "size"
+         << setw(5) << "reps"
+         << setw(14) << "min"
+         << setw(14) << "median"
+         << setw(14) << "p95"
+         << setw(11) << "cv"
+         << setw(16) << "items/s" << "\n";
+
+    vector<BenchResult> results;
+    Runner runner(config);
+    for (const auto &bc : cases) {
+        if (!config.filter.empty() && bc.name.find(config.filter) == string::npos) {
+            continue;
+        }
+        for (size_t n = config.minSize; n <= config.maxSize; n *= 10) {
+            if (bc.sizeLimit != 0 && n > bc.sizeLimit) {
+                break;
+            }
+            bc.run(n, runner);
+            if (runner.samples().empty()) {
+                break;
+            }
+            BenchResult r = summarize(bc.name, n, runner.samples());
+            results.push_back(r);
+            printResult(r);
+            // 更大的规模只会更慢，超出预算后不再继续
+            if (r.medianNs / 1e9 > config.budgetSeconds) {
+                break;
+            }
+            if (n > config.maxSize / 10) {
+                break;
+            }
+        }
+    }
+
+    if (jsonToStdout) cout.rdbuf(tableBuf);
+
+    if (!config.jsonPath.empty()) {
+        if (jsonToStdout) {
+            writeJson(config, results, cout);
+        } else {
+            ofstream out(config.jsonPath);
+            if (!out.is_open() || !writeJson(config, results, out)) {
+                cerr << "无法写入 JSON 文件: " << config.jsonPath << "\n";
+                return 2;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "../include/buffered_writer.h"
+
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ==================== 大块缓冲输出实现 ====================
+
+const char BufferedWriter::kDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+BufferedWriter::BufferedWriter()
+    : buffer(nullptr), used(0), fd(-1), file(nullptr), stream(nullptr), ok(false), direct(false) {}
+
+BufferedWriter::~BufferedWriter() {
+    close();
+}
+
+bool BufferedWriter::open(const std::string &path, bool useDirect) {
+    close();
+    storage.resize(kBufferSize + kAlignment);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(storage.data());
+    buffer = storage.data() + (kAlignment - addr % kAlignment) % kAlignment;
+    used = 0;
+    direct = false;
+#ifndef _WIN32
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (useDirect) {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        // tmpfs 等文件系统不支持 O_DIRECT（EINVAL），改用普通写入
+        direct = fd >= 0;
+    }
+#else
+    (void)useDirect;
+#endif
+    if (fd < 0) {
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    ok = fd >= 0;
+#else
+    (void)useDirect;
+    file = std::fopen(path.c_str(), "wb");
+    if (file) {
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    ok = file != nullptr;
+#endif
+    return ok;
+}
+
+bool BufferedWriter::open(std::ostream &out) {
+    close();
+    storage.resize(kBufferSize);
+    buffer = storage.data();
+    used = 0;
+    direct = false;
+    stream = &out;
+    ok = static_cast<bool>(out);
+    return ok;
+}
+
+bool BufferedWriter::close() {
+    if (!buffer) {
+        return false;
+    }
+    flushBuffer();
+#ifndef _WIN32
+    if (fd >= 0) {
+        ok = (::close(fd) == 0) && ok;
+        fd = -1;
+    }
+#endif
+    if (file) {
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+    }
+    if (stream) {
+        ok = static_cast<bool>(stream->flush()) && ok;
+        stream = nullptr;
+    }
+    std::vector<char>().swap(storage);
+    buffer = nullptr;
+    direct = false;
+    return ok;
+}
+
+void BufferedWriter::writeSlow(const char *data, size_t size) {
+    while (size > 0) {
+        if (used == kBufferSize) {
+            flushBuffer();
+        }
+        size_t n = kBufferSize - used < size ? kBufferSize - used : size;
+        std::memcpy(buffer + used, data, n);
+        used += n;
+        data += n;
+        size -= n;
+    }
+}
+
+void BufferedWriter::flushBuffer() {
+    if (used > 0 && ok) {
+        ok = writeOut(buffer, used);
+    }
+    used = 0;
+}
+
+bool BufferedWriter::writeOut(const char *data, size_t size) {
+    if (stream) {
+        stream->write(data, static_cast<std::streamsize>(size));
+        return static_cast<bool>(*stream);
+    }
+#ifndef _WIN32
+    while (size > 0) {
+#ifdef O_DIRECT
+        // O_DIRECT 要求长度按块对齐：只有最后一块（或被部分写入后的剩余部分）不满，写它之前关闭 O_DIRECT
+        if (direct && size % kAlignment != 0) {
+            int flags = fcntl(fd, F_GETFL);
+            if (flags == -1 || fcntl(fd, F_SETFL, flags & ~O_DIRECT) == -1) {
+                return false;
+            }
+            direct = false;
+        }
+#endif
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+#else
+    return std::fwrite(data, 1, size, file) == size;
+#endif
+}
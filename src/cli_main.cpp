@@ -0,0 +1,440 @@
+#include "../include/election_core.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// ==================== 命令行工具：无界面批量计票 ====================
+//
+// 用法示例：
+//   election_cli tally candidates.csv votes.csv
+//   cat votes.txt | election_cli tally candidates.csv - --txt --time
+//   election_cli winner-stream huge_votes.csv candidates.csv
+//   election_cli topics topics_data.csv
+//   election_cli topics-export - merged.csv < topics_data.csv
+//   election_cli journal-export votes.journal recovered.csv
+//   election_cli topics-snapshot topics_data.csv topics.snap
+//   election_cli snapshot-export topics.snap merged.csv
+
+namespace {
+
+struct CliOptions {
+    bool textFormat;   // 标准输入按文本格式（空白分隔）解析
+    bool showTiming;   // 在标准错误输出各阶段耗时
+    unsigned threads;  // 计票线程数，1 表示单线程，0 表示使用硬件并发数
+    bool directOutput; // 导出文件使用 O_DIRECT
+    vector<string> args;
+
+    CliOptions() : textFormat(false), showTiming(false), threads(1), directOutput(false) {}
+};
+
+class StageTimer {
+public:
+    explicit StageTimer(bool enabled)
+        : enabled_(enabled), start_(std::chrono::steady_clock::now()) {}
+
+    void lap(const char *stage) {
+        auto now = std::chrono::steady_clock::now();
+        if (enabled_) {
+            double ms = std::chrono::duration<double, std::milli>(now - start_).count();
+            cerr << "[time] " << stage << ": " << fixed << setprecision(3) << ms << " ms\n";
+        }
+        start_ = now;
+    }
+
+private:
+    bool enabled_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+void printUsage(const char *prog) {
+    cerr << "用法: " << prog << " <命令> [参数] [选项]\n"
+         << "\n"
+         << "命令:\n"
+         << "  tally <candidates.csv|txt> <votes.csv|txt|->   加载候选人并计票，输出结果与优胜者\n"
+         << "  winner-stream <votes.csv|txt|-> [candidates]     常数内存流式查找过半优胜者（Boyer-Moore）\n"
+         << "  topics <topics_data.csv|->                      导入话题数据并输出汇总\n"
+         << "  topics-export <topics_data.csv|-> <out.csv|->   导入话题数据后重新导出\n"
+         << "  journal-export <votes.journal> <out.csv|->      重放话题投票日志并导出话题数据\n"
+         << "  topics-snapshot <topics_data.csv|-> <out.snap>  导入话题数据并保存为二进制快照\n"
+         << "  snapshot-export <in.snap> <out.csv|->           载入二进制快照并导出话题数据\n"
+         << "\n"
+         << "选项:\n"
+         << "  --txt    从标准输入读取投票时按文本格式（空白分隔）解析，默认按CSV解析\n"
+         << "  --time   在标准错误输出各阶段耗时\n"
+         << "  --threads N  计票使用的线程数（默认 1，0 表示使用全部核心）\n"
+         << "  --direct 导出文件时绕过页缓存（O_DIRECT），适合导出很大的数据\n";
+}
+
+bool parseOptions(int argc, char *argv[], CliOptions &opts) {
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--txt") == 0) {
+            opts.textFormat = true;
+        } else if (std::strcmp(argv[i], "--time") == 0) {
+            opts.showTiming = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--direct") == 0) {
+            opts.directOutput = true;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            cerr << "未知选项: " << argv[i] << "\n";
+            return false;
+        } else {
+            opts.args.push_back(argv[i]);
+        }
+    }
+    return true;
+}
+
+bool loadVotesFrom(const string &source, const CliOptions &opts, vector<int> &votes) {
+    if (source == "-") {
+        std::ios::sync_with_stdio(false);
+        return FileManager::loadVotes(votes, cin, opts.textFormat);
+    }
+    return FileManager::loadVotes(votes, source);
+}
+
+bool importTopicsFrom(const string &source, vector<VoteTopic> &topics,
+                      vector<TopicVoteRecord> &history) {
+    if (source == "-") {
+        std::ios::sync_with_stdio(false);
+        return FileManager::importTopicsData(topics, history, cin);
+    }
+    return FileManager::importTopicsData(topics, history, source);
+}
+
+int runTally(const CliOptions &opts) {
+    if (opts.args.size() != 2) {
+        cerr << "tally 需要两个参数: <候选人文件> <投票文件|->\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    ElectionSystem system;
+
+    vector<Candidate> loaded;
+    if (!FileManager::loadCandidates(loaded, opts.args[0])) {
+        cerr << "无法加载候选人文件: " << opts.args[0] << "\n";
+        return 2;
+    }
+    size_t rejected = loaded.size() - system.addCandidates(loaded);
+    if (rejected > 0) {
+        cerr << "⚠️  警告：跳过 " << rejected << " 条无效或重复的候选人记录\n";
+    }
+    timer.lap("load candidates");
+
+    VoteTallyResult tally;
+    if (opts.threads == 1) {
+        // 单线程：边读边计票，不保留投票历史，内存占用与投票文件大小无关
+        system.setVoteHistoryRetention(VoteHistoryRetention::None);
+        bool ok = false;
+        if (opts.args[1] == "-") {
+            std::ios::sync_with_stdio(false);
+            ok = system.importVotes(cin, opts.textFormat, tally);
+        } else {
+            ok = system.importVotes(opts.args[1], tally);
+        }
+        if (!ok) {
+            cerr << "无法加载投票数据: " << opts.args[1] << "\n";
+            return 2;
+        }
+        timer.lap("load votes + tally");
+    } else {
+        vector<int> votes;
+        if (!loadVotesFrom(opts.args[1], opts, votes)) {
+            cerr << "无法加载投票数据: " << opts.args[1] << "\n";
+            return 2;
+        }
+        timer.lap("load votes");
+
+        tally = system.voteParallel(votes, opts.threads);
+        timer.lap("tally");
+    }
+
+    int winnerID = system.findWinner();
+    timer.lap("find winner");
+
+    const vector<Candidate> &candidates = system.getAllCandidates();
+    long long totalVotes = system.getTotalVotes();
+
+    cout << "选票总数: " << tally.totalCount << "\n";
+    cout << "有效票数: " << tally.validCount << "\n";
+    cout << "无效票数: " << tally.invalidCount << "\n";
+    if (!tally.invalidPositions.empty()) {
+        cout << "无效票位置:";
+        const size_t shown = std::min<size_t>(tally.invalidPositions.size(), 20);
+        for (size_t i = 0; i < shown; ++i) {
+            cout << ' ' << tally.invalidPositions[i];
+        }
+        if (shown < tally.invalidCount) {
+            cout << " ...";
+        }
+        cout << "\n";
+    }
+    cout << "候选人总数: " << candidates.size() << "\n\n";
+    cout << "id,name,department,voteCount,percentage\n";
+    for (const auto &c : candidates) {
+        double percentage = totalVotes > 0 ? (100.0 * c.voteCount / totalVotes) : 0.0;
+        cout << c.id << ',' << c.name << ',' << c.department << ','
+             << c.voteCount << ',' << fixed << setprecision(2) << percentage << "%\n";
+    }
+    cout << "\n";
+    if (winnerID != -1) {
+        const Candidate *winner = system.queryCandidate(winnerID);
+        cout << "优胜者: 编号 " << winnerID;
+        if (winner) {
+            cout << " " << winner->name;
+        }
+        cout << "\n";
+    } else {
+        cout << "没有候选人获得超过半数票！\n";
+    }
+    return 0;
+}
+
+int runWinnerStream(const CliOptions &opts) {
+    if (opts.args.empty() || opts.args.size() > 2) {
+        cerr << "winner-stream 需要参数: <投票文件|-> [候选人文件]\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    ElectionSystem system;
+    if (opts.args.size() == 2) {
+        vector<Candidate> loaded;
+        if (!FileManager::loadCandidates(loaded, opts.args[1])) {
+            cerr << "无法加载候选人文件: " << opts.args[1] << "\n";
+            return 2;
+        }
+        system.addCandidates(loaded);
+        timer.lap("load candidates");
+    }
+
+    StreamingWinnerResult result;
+    if (opts.args[0] == "-") {
+        std::ios::sync_with_stdio(false);
+        result = system.findWinnerStreaming(cin, opts.textFormat);
+    } else if (!system.findWinnerStreaming(opts.args[0], result)) {
+        cerr << "无法打开投票文件: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("stream winner");
+
+    cout << "有效票数: " << result.validVotes << "\n";
+    cout << "无效票数: " << result.invalidVotes << "\n";
+    if (!result.verified) {
+        cout << "多数候选: " << result.majorityCandidate << "（输入不可回读，未校验是否过半）\n";
+        return 0;
+    }
+    if (result.winnerID != -1) {
+        cout << "优胜者: 编号 " << result.winnerID << "（" << result.candidateVotes << " 票）\n";
+    } else {
+        cout << "没有候选人获得超过半数票！\n";
+    }
+    return 0;
+}
+
+int runTopics(const CliOptions &opts) {
+    if (opts.args.size() != 1) {
+        cerr << "topics 需要一个参数: <话题数据文件|->\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    vector<VoteTopic> topics;
+    vector<TopicVoteRecord> history;
+    if (!importTopicsFrom(opts.args[0], topics, history)) {
+        cerr << "无法导入话题数据: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("import topics");
+
+    ElectionSystem system;
+    system.loadTopicsData(topics, history);
+    timer.lap("load topics");
+
+    cout << "话题总数: " << system.getAllTopics().size() << "\n";
+    cout << "投票记录数: " << system.getTopicVoteCount() << "\n\n";
+    for (const auto &t : system.getAllTopics()) {
+        long long totalVotes = system.getTopicTotalVotes(t.id);
+        cout << "[" << t.id << "] " << t.title
+             << "（总票数 " << totalVotes << "，每人可投 " << t.votesPerVoter << " 票）\n";
+        for (const auto &opt : t.options) {
+            double percentage = totalVotes > 0 ? (100.0 * opt.voteCount / totalVotes) : 0.0;
+            cout << "    " << opt.id << ". " << opt.text << " : " << opt.voteCount
+                 << " 票 (" << fixed << setprecision(2) << percentage << "%)\n";
+        }
+        int winnerOptId = system.getTopicWinner(t.id);
+        if (winnerOptId != -1) {
+            cout << "    优胜选项: " << winnerOptId << "\n";
+        } else {
+            cout << "    暂无优胜选项\n";
+        }
+    }
+    return 0;
+}
+
+int runTopicsExport(const CliOptions &opts) {
+    if (opts.args.size() != 2) {
+        cerr << "topics-export 需要两个参数: <输入文件|-> <输出文件|->\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    vector<VoteTopic> topics;
+    vector<TopicVoteRecord> history;
+    if (!importTopicsFrom(opts.args[0], topics, history)) {
+        cerr << "无法导入话题数据: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("import topics");
+
+    ElectionSystem system;
+    system.loadTopicsData(topics, history);
+    timer.lap("load topics");
+
+    bool ok = false;
+    if (opts.args[1] == "-") {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), cout);
+    } else {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), opts.args[1]);
+    }
+    if (!ok) {
+        cerr << "导出失败: " << opts.args[1] << "\n";
+        return 2;
+    }
+    timer.lap("export topics");
+    return 0;
+}
+
+int runJournalExport(const CliOptions &opts) {
+    if (opts.args.size() != 2) {
+        cerr << "journal-export 需要两个参数: <日志文件> <输出文件|->\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    ElectionSystem system;
+    // 只读重放：导出不写入、不截断日志文件
+    if (!ifstream(opts.args[0].c_str(), ios::binary) || !system.replayJournal(opts.args[0])) {
+        cerr << "无法读取话题投票日志: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("replay journal");
+
+    bool ok = false;
+    if (opts.args[1] == "-") {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), cout);
+    } else {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), opts.args[1]);
+    }
+    if (!ok) {
+        cerr << "导出失败: " << opts.args[1] << "\n";
+        return 2;
+    }
+    timer.lap("export topics");
+    return 0;
+}
+
+int runTopicsSnapshot(const CliOptions &opts) {
+    if (opts.args.size() != 2) {
+        cerr << "topics-snapshot 需要两个参数: <输入文件|-> <快照文件>\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    vector<VoteTopic> topics;
+    vector<TopicVoteRecord> history;
+    if (!importTopicsFrom(opts.args[0], topics, history)) {
+        cerr << "无法导入话题数据: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("import topics");
+
+    ElectionSystem system;
+    system.loadTopicsData(topics, history);
+    timer.lap("load topics");
+
+    if (!system.saveSnapshot(opts.args[1])) {
+        cerr << "无法保存快照: " << opts.args[1] << "\n";
+        return 2;
+    }
+    timer.lap("save snapshot");
+    return 0;
+}
+
+int runSnapshotExport(const CliOptions &opts) {
+    if (opts.args.size() != 2) {
+        cerr << "snapshot-export 需要两个参数: <快照文件> <输出文件|->\n";
+        return 1;
+    }
+
+    StageTimer timer(opts.showTiming);
+    ElectionSystem system;
+    if (!system.loadSnapshot(opts.args[0])) {
+        cerr << "无法载入快照: " << opts.args[0] << "\n";
+        return 2;
+    }
+    timer.lap("load snapshot");
+
+    bool ok = false;
+    if (opts.args[1] == "-") {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), cout);
+    } else {
+        ok = FileManager::exportTopicsData(system.getAllTopics(), system.getTopicVoteHistory(), opts.args[1]);
+    }
+    if (!ok) {
+        cerr << "导出失败: " << opts.args[1] << "\n";
+        return 2;
+    }
+    timer.lap("export topics");
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    CliOptions opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    FileManager::setDirectOutput(opts.directOutput);
+
+    string command = argv[1];
+    if (command == "tally") {
+        return runTally(opts);
+    }
+    if (command == "winner-stream") {
+        return runWinnerStream(opts);
+    }
+    if (command == "topics") {
+        return runTopics(opts);
+    }
+    if (command == "topics-export") {
+        return runTopicsExport(opts);
+    }
+    if (command == "journal-export") {
+        return runJournalExport(opts);
+    }
+    if (command == "topics-snapshot") {
+        return runTopicsSnapshot(opts);
+    }
+    if (command == "snapshot-export") {
+        return runSnapshotExport(opts);
+    }
+    if (command == "-h" || command == "--help" || command == "help") {
+        printUsage(argv[0]);
+        return 0;
+    }
+
+    cerr << "未知命令: " << command << "\n";
+    printUsage(argv[0]);
+    return 1;
+}
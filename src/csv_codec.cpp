@@ -0,0 +1,208 @@
+#include "../include/csv_codec.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ELECTION_HAVE_SSE2_CSV 1
+#include <emmintrin.h>
+#endif
+
+// ==================== CSV 编解码实现 ====================
+
+namespace {
+
+struct BlockMasks {
+    uint64_t quotes;
+    uint64_t commas;
+    uint64_t newlines;
+};
+
+#ifdef ELECTION_HAVE_SSE2_CSV
+inline uint64_t matchMask(__m128i v, char c) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+}
+#endif
+
+// 64 字节中引号、逗号、换行所在位置的位掩码（第 i 位对应第 i 个字节）
+inline BlockMasks classify(const char *p) {
+    BlockMasks m = {0, 0, 0};
+#ifdef ELECTION_HAVE_SSE2_CSV
+    for (size_t i = 0; i < CsvReader::kBlockBytes; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        m.quotes |= matchMask(v, '"') << i;
+        m.commas |= matchMask(v, ',') << i;
+        m.newlines |= matchMask(v, '\n') << i;
+    }
+#else
+    for (size_t i = 0; i < CsvReader::kBlockBytes; i++) {
+        uint64_t bit = 1ULL << i;
+        m.quotes |= p[i] == '"' ? bit : 0;
+        m.commas |= p[i] == ',' ? bit : 0;
+        m.newlines |= p[i] == '\n' ? bit : 0;
+    }
+#endif
+    return m;
+}
+
+// 前缀异或：结果第 i 位为 x 第 0..i 位的异或，即第 i 个字节之前（含）引号个数的奇偶
+inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+} // namespace
+
+// ---------- CsvReader ----------
+
+CsvReader::CsvReader(const char *data, size_t size)
+    : start(data), end(data + size), cursor(data), blockBase(data),
+      pendingCommas(0), pendingNewlines(0), insideCarry(0), lenient(false) {
+    if (size > 0) {
+        loadBlock(data);
+    }
+}
+
+void CsvReader::loadBlock(const char *base) {
+    blockBase = base;
+    BlockMasks m;
+    if (static_cast<size_t>(end - base) >= kBlockBytes) {
+        m = classify(base);
+    } else {
+        // 末尾不足一块：复制到补零的缓冲区，0 不会被当作分隔符
+        char tail[kBlockBytes] = {0};
+        std::memcpy(tail, base, static_cast<size_t>(end - base));
+        m = classify(tail);
+    }
+    uint64_t inside = prefixXor(m.quotes) ^ insideCarry;
+    if (m.quotes != 0 && !quotesWellFormed(base, m.quotes, inside, m.quotes | m.commas | m.newlines)) {
+        lenient = true;
+        return;
+    }
+    insideCarry = static_cast<uint64_t>(-static_cast<int64_t>(inside >> 63));
+    pendingCommas = m.commas & ~inside;
+    pendingNewlines = m.newlines & ~inside;
+}
+
+// 按奇偶判定的开引号（该位之后位于引号内）前一字节、闭引号后一字节须为分隔符或引号
+bool CsvReader::quotesWellFormed(const char *base, uint64_t quotes, uint64_t inside, uint64_t boundaries) const {
+    size_t length = static_cast<size_t>(end - base) < kBlockBytes ? static_cast<size_t>(end - base) : kBlockBytes;
+    uint64_t prevOk = boundaries << 1;
+    if (base == start || isQuoteBoundary(base[-1])) {
+        prevOk |= 1;
+    }
+    uint64_t nextOk = boundaries >> 1;
+    if (base + length == end || isQuoteBoundary(base[length])) {
+        nextOk |= 1ULL << (length - 1);
+    }
+    uint64_t bad = (quotes & inside & ~prevOk) | (quotes & ~inside & ~nextOk);
+    while (bad != 0) {
+        // 闭引号后的 '\r'（CRLF 换行）同样可以
+        size_t i = lowestSetBit(bad);
+        bad &= bad - 1;
+        if ((inside >> i) & 1 || base[i + 1] != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* CsvReader::quotedFieldEnd(const char *quote, const char *end) {
+    const char *p = quote + 1;
+    for (;;) {
+        const char *close = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(end - p)));
+        if (!close) {
+            return nullptr;
+        }
+        p = close + 1;
+        if (p < end && *p == '"') {
+            p++;    // 转义的引号
+            continue;
+        }
+        return p == end || *p == ',' || *p == '\n' || *p == '\r' ? p : nullptr;
+    }
+}
+
+size_t CsvReader::nextLenient(CsvField *fields, size_t maxFields) {
+    if (cursor >= end) {
+        return 0;
+    }
+    size_t count = 0;
+    const char *p = cursor;
+    for (;;) {
+        const char *fieldStart = p;
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        // 引号字段：两个引号为转义，单个引号结束；闭引号后不是分隔符（或没有闭引号）时整个字段按普通字符处理
+        const char *quotedEnd = p < end && *p == '"' ? quotedFieldEnd(p, end) : nullptr;
+        if (quotedEnd) {
+            p = quotedEnd;
+        }
+        while (p < end && *p != ',' && *p != '\n') {
+            p++;
+        }
+        bool lastField = p == end || *p == '\n';
+        if (count < maxFields) {
+            fields[count] = makeField(fieldStart, lastField ? stripCarriageReturn(fieldStart, p) : p, quotedEnd != nullptr);
+        }
+        count++;
+        if (lastField) {
+            cursor = p == end ? end : p + 1;
+            return count;
+        }
+        p++;
+    }
+}
+
+// ---------- CsvCodec ----------
+
+const unsigned char CsvCodec::kSpecialChars[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0,     // '\n' '\r'
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,     // '"' ','
+};
+
+void CsvCodec::decode(const CsvField &field, std::string &out) {
+    if (!field.quoted) {
+        out.assign(field.begin, field.end);
+        return;
+    }
+    out.clear();
+    const char *p = static_cast<const char*>(std::memchr(field.begin, '"', static_cast<size_t>(field.end - field.begin))) + 1;
+    // 闭合引号之后的内容（通常只有空白）忽略
+    while (p < field.end) {
+        const char *quote = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(field.end - p)));
+        if (!quote) {
+            out.append(p, field.end);
+            break;
+        }
+        out.append(p, quote);
+        if (quote + 1 < field.end && quote[1] == '"') {
+            out.push_back('"');
+            p = quote + 2;
+        } else {
+            break;
+        }
+    }
+}
+
+void CsvCodec::writeQuoted(BufferedWriter &out, const char *data, size_t size) {
+    const char *end = data + size;
+    out.put('"');
+    while (data < end) {
+        const char *quote = static_cast<const char*>(std::memchr(data, '"', static_cast<size_t>(end - data)));
+        if (!quote) {
+            out.write(data, static_cast<size_t>(end - data));
+            break;
+        }
+        out.write(data, static_cast<size_t>(quote + 1 - data));
+        out.put('"');
+        data = quote + 1;
+    }
+    out.put('"');
+}
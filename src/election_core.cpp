@@ -1,5 +1,14 @@
 #include "../include/election_core.h"
+#include "../include/vote_histogram.h"
+#include "../include/vote_parser.h"
+#include "../include/buffered_writer.h"
+#include "../include/csv_codec.h"
 #include <iostream>
+#include <cstdio>
+#include <climits>
+#include <queue>
+#include <thread>
+#include <atomic>
 
 // ==================== 文件管理模块实现（CSV / 文本格式） ====================
 
@@ -20,41 +29,130 @@ static std::string trim(const std::string &s) {
     return s.substr(start, end - start + 1);
 }
 
+// 读入输入流的全部内容
+static bool readAll(istream &in, string &data) {
+    data.clear();
+    char buffer[1 << 16];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        data.append(buffer, static_cast<size_t>(in.gcount()));
+    }
+    return !in.bad();
+}
+
+// 取得文件全部内容：普通文件只读映射，无法映射时（例如管道）读入 buffer
+static bool loadFileData(const string &filename, MappedFile &mapped, string &buffer,
+                         const char *&data, size_t &size) {
+    if (mapped.open(filename)) {
+        data = mapped.data();
+        size = mapped.size();
+        return true;
+    }
+    ifstream file(filename, std::ios::binary);
+    if (!file.is_open() || !readAll(file, buffer)) {
+        return false;
+    }
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+// 导出是否使用 O_DIRECT（见 FileManager::setDirectOutput）
+static std::atomic<bool> directOutput(false);
+
+void FileManager::setDirectOutput(bool enabled) {
+    directOutput = enabled;
+}
+
+bool FileManager::getDirectOutput() {
+    return directOutput;
+}
+
 bool FileManager::saveCandidates(const vector<Candidate> &candidates, 
                                   const string &filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
+    BufferedWriter file;
+    if (!file.open(filename, directOutput)) {
         return false;
     }
     std::string ext = getFileExtensionLower(filename);
     
     if (ext == "txt") {
         // 文本格式：简单空白分隔，便于人工查看与编辑
-        file << "id name department voteCount\n";
+        file.write("id name department voteCount\n");
         for (const auto &c : candidates) {
-            file << c.id << ' '
-                 << c.name << ' '
-                 << c.department << ' '
-                 << c.voteCount << '\n';
+            file.writeInt(c.id);
+            file.put(' ');
+            file.write(c.name);
+            file.put(' ');
+            file.write(c.department);
+            file.put(' ');
+            file.writeInt(c.voteCount);
+            file.put('\n');
         }
     } else {
-        // 默认CSV格式: id,name,department,voteCount
-        file << "id,name,department,voteCount\n";
+        // 默认CSV格式: id,name,department,voteCount；姓名和单位按需加引号（RFC 4180）
+        file.write("id,name,department,voteCount\n");
         for (const auto &c : candidates) {
-            // 简化处理：假定姓名和单位中不包含逗号
-            file << c.id << ','
-                 << c.name << ','
-                 << c.department << ','
-                 << c.voteCount << '\n';
+            file.writeInt(c.id);
+            file.put(',');
+            CsvCodec::writeField(file, c.name);
+            file.put(',');
+            CsvCodec::writeField(file, c.department);
+            file.put(',');
+            file.writeInt(c.voteCount);
+            file.put('\n');
         }
     }
     
-    file.close();
+    return file.close();
+}
+
+// CSV格式（RFC 4180）：首条记录为表头，其后每条记录一个候选人；未加引号的字段去掉首尾空白
+static bool loadCandidatesCsv(vector<Candidate> &candidates, const string &filename) {
+    MappedFile mapped;
+    string buffer;
+    const char *data = nullptr;
+    size_t size = 0;
+    if (!loadFileData(filename, mapped, buffer, data, size)) {
+        return false;
+    }
+    candidates.clear();
+
+    CsvReader reader(data, size);
+    CsvField fields[4];
+    if (reader.next(fields, 4) == 0) {
+        return false;
+    }
+    string values[4];
+    while (size_t count = reader.next(fields, 4)) {
+        if (count < 4) continue;
+        for (size_t i = 0; i < 4; i++) {
+            CsvCodec::decode(fields[i], values[i]);
+            if (!fields[i].quoted) {
+                values[i] = trim(values[i]);
+            }
+        }
+        
+        Candidate c;
+        try {
+            c.id = std::stoi(values[0]);
+            c.name = values[1];
+            c.department = values[2];
+            c.voteCount = std::stoi(values[3]);
+        } catch (...) {
+            continue; // 跳过格式错误的行
+        }
+        
+        candidates.push_back(c);
+    }
     return true;
 }
 
 bool FileManager::loadCandidates(vector<Candidate> &candidates, 
                                  const string &filename) {
+    if (getFileExtensionLower(filename) != "txt") {
+        return loadCandidatesCsv(candidates, filename);
+    }
+
     ifstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -62,72 +160,39 @@ bool FileManager::loadCandidates(vector<Candidate> &candidates,
     
     candidates.clear();
     std::string line;
-    std::string ext = getFileExtensionLower(filename);
     
-    if (ext == "txt") {
-        // 文本格式：支持首行表头；每行按空白切分: id name department voteCount
-        bool firstLine = true;
-        while (std::getline(file, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            
-            std::stringstream ss(line);
-            std::string idStr, name, dept, voteStr;
-            if (!(ss >> idStr >> name >> dept)) {
-                // 可能是表头
-                if (firstLine) {
-                    firstLine = false;
-                }
-                continue;
-            }
-            // voteCount 可选，缺省为0
-            if (!(ss >> voteStr)) {
-                voteStr = "0";
-            }
-            
-            Candidate c;
-            try {
-                c.id = std::stoi(trim(idStr));
-                c.name = trim(name);
-                c.department = trim(dept);
-                c.voteCount = std::stoi(trim(voteStr));
-            } catch (...) {
-                continue; // 跳过格式错误的行
+    // 文本格式：支持首行表头；每行按空白切分: id name department voteCount
+    bool firstLine = true;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+        
+        std::stringstream ss(line);
+        std::string idStr, name, dept, voteStr;
+        if (!(ss >> idStr >> name >> dept)) {
+            // 可能是表头
+            if (firstLine) {
+                firstLine = false;
             }
-            
-            candidates.push_back(c);
-            firstLine = false;
+            continue;
         }
-    } else {
-        // CSV格式：首行表头，其后每行一个候选人
-        if (!std::getline(file, line)) {
-            return false;
+        // voteCount 可选，缺省为0
+        if (!(ss >> voteStr)) {
+            voteStr = "0";
         }
         
-        while (std::getline(file, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            
-            std::stringstream ss(line);
-            std::string idStr, name, dept, voteStr;
-            
-            if (!std::getline(ss, idStr, ',')) continue;
-            if (!std::getline(ss, name, ',')) continue;
-            if (!std::getline(ss, dept, ',')) continue;
-            if (!std::getline(ss, voteStr, ',')) continue;
-            
-            Candidate c;
-            try {
-                c.id = std::stoi(trim(idStr));
-                c.name = trim(name);
-                c.department = trim(dept);
-                c.voteCount = std::stoi(trim(voteStr));
-            } catch (...) {
-                continue; // 跳过格式错误的行
-            }
-            
-            candidates.push_back(c);
+        Candidate c;
+        try {
+            c.id = std::stoi(trim(idStr));
+            c.name = trim(name);
+            c.department = trim(dept);
+            c.voteCount = std::stoi(trim(voteStr));
+        } catch (...) {
+            continue; // 跳过格式错误的行
         }
+        
+        candidates.push_back(c);
+        firstLine = false;
     }
     
     file.close();
@@ -136,95 +201,114 @@ bool FileManager::loadCandidates(vector<Candidate> &candidates,
 
 bool FileManager::saveVotes(const vector<int> &votes, 
                             const string &filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
+    BufferedWriter file;
+    if (!file.open(filename, directOutput)) {
         return false;
     }
     std::string ext = getFileExtensionLower(filename);
     
-    if (ext == "txt") {
-        // 文本格式：每行一个投票ID，不写表头
-        for (int v : votes) {
-            file << v << '\n';
-        }
-    } else {
-        // CSV格式：首行表头“vote”，每行一个ID
-        file << "vote\n";
-        for (int v : votes) {
-            file << v << '\n';
-        }
+    // 文本格式：每行一个投票ID，不写表头；CSV格式：首行表头“vote”，每行一个ID
+    if (ext != "txt") {
+        file.write("vote\n", 5);
+    }
+    for (int v : votes) {
+        file.writeInt(v);
+        file.put('\n');
     }
     
-    file.close();
-    return true;
+    return file.close();
 }
 
 bool FileManager::loadVotes(vector<int> &votes, 
                             const string &filename) {
+    bool textFormat = getFileExtensionLower(filename) == "txt";
+    // 普通文件映射后直接解析，不逐行复制；无法映射时（例如管道）按流读取
+    votes.clear();
+    size_t size = 0;
+    if (VoteParser::parseFile(filename, textFormat, [&votes](int v) { votes.push_back(v); }, &size)) {
+        // CSV格式要求至少有一行（表头或数据），即文件非空
+        return textFormat || size > 0;
+    }
+
     ifstream file(filename);
     if (!file.is_open()) {
         return false;
     }
     
+    bool ok = loadVotes(votes, file, textFormat);
+    file.close();
+    return ok;
+}
+
+bool FileManager::loadVotes(vector<int> &votes, istream &in, bool textFormat) {
     votes.clear();
-    std::string line;
-    std::string ext = getFileExtensionLower(filename);
-    
-    if (ext == "txt") {
-        // 文本格式：支持空白分隔或每行一个数字，无强制表头
-        while (std::getline(file, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            
-            std::stringstream ss(line);
-            std::string token;
-            while (ss >> token) {
-                try {
-                    int v = std::stoi(token);
-                    votes.push_back(v);
-                } catch (...) {
-                    // 忽略非数字token
-                    continue;
+    VoteStreamReader reader(in, textFormat);
+    int v = 0;
+    while (reader.next(v)) {
+        votes.push_back(v);
+    }
+    // CSV格式要求至少有一行（表头或数据）
+    return textFormat || reader.linesRead() > 0;
+}
+
+VoteStreamReader::VoteStreamReader(istream &input, bool text)
+    : in(input), textFormat(text), lines(0), tokenPos(0) {}
+
+bool VoteStreamReader::next(int &vote) {
+    if (textFormat) {
+        // 文本格式：支持空白分隔或每行一个数字，无强制表头；非数字token跳过
+        while (true) {
+            const char *begin = line.data();
+            const char *end = begin + line.size();
+            const char *p = begin + tokenPos;
+            while (p < end) {
+                while (p < end && VoteParser::isSpace(*p)) p++;
+                if (p == end) break;
+                const char *q = VoteParser::parseInt(p, end, vote);
+                const char *tokenEnd = q ? q : p;
+                while (tokenEnd < end && !VoteParser::isSpace(*tokenEnd)) tokenEnd++;
+                p = tokenEnd;
+                if (q) {
+                    tokenPos = static_cast<size_t>(p - begin);
+                    return true;
                 }
             }
-        }
-    } else {
-        // CSV格式：首行可能是表头，也可能就是第一个数字
-        if (!std::getline(file, line)) {
-            return false;
-        }
-        
-        line = trim(line);
-        if (!line.empty()) {
-            try {
-                int v0 = std::stoi(line);
-                votes.push_back(v0);
-            } catch (...) {
-                // 视为表头，忽略
+            if (!std::getline(in, line)) {
+                return false;
             }
+            lines++;
+            tokenPos = 0;
         }
-        
-        while (std::getline(file, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            
-            try {
-                int v = std::stoi(line);
-                votes.push_back(v);
-            } catch (...) {
-                // 跳过非数字行（例如表头）
-                continue;
-            }
+    }
+
+    // CSV格式：首行可能是表头，也可能就是第一个数字；非数字行（例如表头）跳过
+    while (std::getline(in, line)) {
+        lines++;
+        if (VoteParser::parseInt(line.data(), line.data() + line.size(), vote)) {
+            return true;
         }
     }
-    
-    file.close();
-    return true;
+    return false;
 }
 
 bool FileManager::exportReport(const vector<Candidate> &candidates, 
                                int winnerID, 
                                const string &filename) {
+    // 按得票数降序排列指针，不复制候选人
+    vector<const Candidate*> ranked;
+    ranked.reserve(candidates.size());
+    for (const auto &c : candidates) {
+        ranked.push_back(&c);
+    }
+    stable_sort(ranked.begin(), ranked.end(), [](const Candidate *a, const Candidate *b) {
+        return a->voteCount > b->voteCount;
+    });
+    return exportReport(ranked, winnerID, filename);
+}
+
+bool FileManager::exportReport(const vector<const Candidate*> &ranked, 
+                               int winnerID, 
+                               const string &filename) {
     ofstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -238,12 +322,12 @@ bool FileManager::exportReport(const vector<Candidate> &candidates,
     file << "----------------------------------------\n\n";
     
     int totalVotes = 0;
-    for (const auto &c : candidates) {
-        totalVotes += c.voteCount;
+    for (const Candidate *c : ranked) {
+        totalVotes += c->voteCount;
     }
     
     file << "总票数: " << totalVotes << "\n";
-    file << "候选人总数: " << candidates.size() << "\n\n";
+    file << "候选人总数: " << ranked.size() << "\n\n";
     
     file << "候选人得票情况:\n";
     file << "----------------------------------------\n";
@@ -254,29 +338,26 @@ bool FileManager::exportReport(const vector<Candidate> &candidates,
          << setw(15) << "得票率" << "\n";
     file << "----------------------------------------\n";
     
-    vector<Candidate> sorted = candidates;
-    sort(sorted.begin(), sorted.end());
-    
-    for (const auto &c : sorted) {
+    for (const Candidate *c : ranked) {
         double percentage = totalVotes > 0 ? 
-            (100.0 * c.voteCount / totalVotes) : 0.0;
-        file << left << setw(8) << c.id 
-             << setw(20) << c.name 
-             << setw(20) << c.department 
-             << setw(10) << c.voteCount 
+            (100.0 * c->voteCount / totalVotes) : 0.0;
+        file << left << setw(8) << c->id 
+             << setw(20) << c->name 
+             << setw(20) << c->department 
+             << setw(10) << c->voteCount 
              << fixed << setprecision(2) << setw(15) << percentage << "%\n";
     }
     
     file << "\n----------------------------------------\n";
     if (winnerID != -1) {
         file << "优胜者: 编号 " << winnerID << "\n";
-        for (const auto &c : candidates) {
-            if (c.id == winnerID) {
-                file << "姓名: " << c.name << "\n";
-                file << "所属单位: " << c.department << "\n";
-                file << "得票数: " << c.voteCount << "\n";
+        for (const Candidate *c : ranked) {
+            if (c->id == winnerID) {
+                file << "姓名: " << c->name << "\n";
+                file << "所属单位: " << c->department << "\n";
+                file << "得票数: " << c->voteCount << "\n";
                 double percentage = totalVotes > 0 ? 
-                    (100.0 * c.voteCount / totalVotes) : 0.0;
+                    (100.0 * c->voteCount / totalVotes) : 0.0;
                 file << "得票率: " << fixed << setprecision(2) 
                      << percentage << "%\n";
                 break;
@@ -293,182 +374,506 @@ bool FileManager::exportReport(const vector<Candidate> &candidates,
 
 
 
-bool FileManager::exportTopicsData(const vector<VoteTopic> &topics,
-                                  const vector<TopicVoteRecord> &voteHistory,
-                                  const string &filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
-        return false;
+// ---------- 话题数据导出：字段直接格式化进 BufferedWriter，文本字段按需加引号 ----------
+
+namespace {
+
+void writeTopicsHeader(BufferedWriter &file) {
+    file.write("#TOPICS\n");
+    file.write("topicId,title,description,createdAt,votesPerVoter\n");
+}
+
+void writeTopicRow(BufferedWriter &file, const VoteTopic &t) {
+    file.writeInt(t.id);
+    file.put(',');
+    CsvCodec::writeField(file, t.title);
+    file.put(',');
+    CsvCodec::writeField(file, t.description);
+    file.put(',');
+    file.writeInt(static_cast<long long>(t.createdAt));
+    file.put(',');
+    file.writeInt(t.votesPerVoter);
+    file.put('\n');
+}
+
+void writeOptionsHeader(BufferedWriter &file) {
+    file.write("#OPTIONS\n");
+    file.write("topicId,optionId,text,voteCount\n");
+}
+
+void writeOptionRows(BufferedWriter &file, const VoteTopic &t) {
+    for (const auto &opt : t.options) {
+        file.writeInt(t.id);
+        file.put(',');
+        file.writeInt(opt.id);
+        file.put(',');
+        CsvCodec::writeField(file, opt.text);
+        file.put(',');
+        file.writeInt(opt.voteCount);
+        file.put('\n');
     }
+}
+
+void writeVotesHeader(BufferedWriter &file) {
+    file.write("#VOTES\n");
+    file.write("topicId,voterId,optionId,votedAt\n");
+}
 
+void writeVoteRow(BufferedWriter &file, const TopicVoteRecord &rec) {
+    file.writeInt(rec.topicId);
+    file.put(',');
+    CsvCodec::writeField(file, rec.voterId);
+    file.put(',');
+    file.writeInt(rec.optionId);
+    file.put(',');
+    file.writeInt(static_cast<long long>(rec.votedAt));
+    file.put('\n');
+}
+
+bool writeTopicsData(BufferedWriter &file, const vector<VoteTopic> &topics,
+                     const vector<TopicVoteRecord> &voteHistory) {
     // Section 1: topics
-    file << "#TOPICS\n";
-    file << "topicId,title,description,createdAt,votesPerVoter\n";
+    writeTopicsHeader(file);
     for (const auto &t : topics) {
-        // 简化：假设 title/description 不包含逗号（如需更强健可做CSV转义）
-        file << t.id << ','
-             << t.title << ','
-             << t.description << ','
-             << static_cast<long long>(t.createdAt) << ','
-             << t.votesPerVoter << '\n';
+        writeTopicRow(file, t);
     }
 
     // Section 2: options
-    file << "#OPTIONS\n";
-    file << "topicId,optionId,text,voteCount\n";
+    writeOptionsHeader(file);
     for (const auto &t : topics) {
-        for (const auto &opt : t.options) {
-            file << t.id << ','
-                 << opt.id << ','
-                 << opt.text << ','
-                 << opt.voteCount << '\n';
-        }
+        writeOptionRows(file, t);
     }
 
     // Section 3: votes
-    file << "#VOTES\n";
-    file << "topicId,voterId,optionId,votedAt\n";
+    writeVotesHeader(file);
     for (const auto &rec : voteHistory) {
-        file << rec.topicId << ','
-             << rec.voterId << ','
-             << rec.optionId << ','
-             << static_cast<long long>(rec.votedAt) << '\n';
+        writeVoteRow(file, rec);
     }
 
-    file.close();
-    return true;
+    return file.close();
 }
 
-bool FileManager::importTopicsData(vector<VoteTopic> &topics,
-                                  vector<TopicVoteRecord> &voteHistory,
+} // namespace
+
+bool FileManager::exportTopicsData(const vector<VoteTopic> &topics,
+                                  const vector<TopicVoteRecord> &voteHistory,
                                   const string &filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
+    BufferedWriter file;
+    if (!file.open(filename, directOutput)) {
         return false;
     }
+    return writeTopicsData(file, topics, voteHistory);
+}
 
-    topics.clear();
-    voteHistory.clear();
+bool FileManager::exportTopicsData(const vector<VoteTopic> &topics,
+                                  const vector<TopicVoteRecord> &voteHistory,
+                                  ostream &out) {
+    BufferedWriter file;
+    if (!file.open(out)) {
+        return false;
+    }
+    return writeTopicsData(file, topics, voteHistory);
+}
 
-    string line;
-    enum class Section { None, Topics, Options, Votes };
-    Section sec = Section::None;
+// ---------- 话题数据导入：定位分段，#VOTES 段多线程解析 ----------
 
-    // Temporary map: topicId -> index
-    unordered_map<int, size_t> tidToIdx;
+namespace {
+
+enum class TopicsSection { None, Topics, Options, Votes };
+
+// 一个分段的内容：段标记的下一行到下一个段标记所在行之前
+struct SectionRange {
+    TopicsSection type;
+    const char *begin;
+    const char *end;
+};
+
+// #VOTES 段的解析结果，按列存放；投票人ID首尾相接存放在 voterIds 中
+struct VoteColumns {
+    vector<int> topicIds;
+    vector<int> optionIds;
+    vector<long long> votedAt;
+    string voterIds;
+    vector<size_t> voterEnds;   // 第 i 个投票人ID为 voterIds[voterEnds[i-1], voterEnds[i])
+};
+
+// 每个线程至少分到的 #VOTES 数据量，更小的文件直接单线程解析
+const size_t kMinVoteBytesPerThread = 1u << 20;
+
+inline bool isTrimChar(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-    auto splitCsv = [](const string &s) {
-        vector<string> out;
-        string cur;
-        for (char ch : s) {
-            if (ch == ',') {
-                out.push_back(cur);
-                cur.clear();
+// 与 trim 相同：去掉首尾的 " \t\r\n"
+inline void trimRange(const char *&b, const char *&e) {
+    while (b < e && isTrimChar(*b)) b++;
+    while (e > b && isTrimChar(e[-1])) e--;
+}
+
+inline bool rangeEquals(const char *b, const char *e, const char *text) {
+    size_t n = std::strlen(text);
+    return static_cast<size_t>(e - b) == n && std::memcmp(b, text, n) == 0;
+}
+
+inline const char* findChar(const char *b, const char *e, char c) {
+    return b < e ? static_cast<const char*>(std::memchr(b, c, static_cast<size_t>(e - b))) : nullptr;
+}
+
+/**
+ * 引号状态：判断某位置是否位于引号字段内（与 CsvReader 的判定一致）
+ * 只有字段开头（可有前导空白）、且闭引号之后紧跟分隔符、行尾或数据末尾的引号开始引号字段
+ * （CsvReader::quotedFieldEnd），其余引号按普通字符处理（旧版未加引号的文件）；
+ * 引号字段内两个引号为转义，单个引号结束该字段。符合 RFC 4180 的数据上与按引号个数奇偶判定相同。
+ * 只在引号处停下，不含引号的数据只需一次 memchr；查询位置须单调不减
+ */
+class QuoteParity {
+public:
+    QuoteParity(const char *begin, const char *end)
+        : begin(begin), nextQuote(findChar(begin, end, '"')), end(end), inside(false) {}
+
+    bool insideAt(const char *pos) {
+        while (nextQuote && nextQuote < pos) {
+            const char *quote = nextQuote;
+            const char *resume = quote + 1;
+            if (!inside) {
+                inside = startsField(quote) && CsvReader::quotedFieldEnd(quote, end);
+            } else if (resume < end && *resume == '"') {
+                resume++;   // 转义的引号
             } else {
-                cur.push_back(ch);
+                inside = false;
             }
+            nextQuote = findChar(resume, end, '"');
         }
-        out.push_back(cur);
-        return out;
-    };
+        return inside;
+    }
 
-    while (std::getline(file, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
+private:
+    const char *begin;
+    const char *nextQuote;
+    const char *end;
+    bool inside;
+
+    bool startsField(const char *quote) const {
+        const char *p = quote;
+        while (p > begin && (p[-1] == ' ' || p[-1] == '\t')) {
+            p--;
+        }
+        return p == begin || p[-1] == ',' || p[-1] == '\n';
+    }
+};
+
+/**
+ * 找出全部段标记行（去空白后为 #TOPICS / #OPTIONS / #VOTES），把数据切成若干段
+ * 只检查含 '#' 的行，用 memchr 跳过其余内容；位于引号字段内的行不是段标记；第一个段标记之前的内容为 None 段
+ */
+vector<SectionRange> findSections(const char *data, size_t size) {
+    vector<SectionRange> sections;
+    const char *end = data + size;
+    SectionRange current = {TopicsSection::None, data, end};
+    QuoteParity quotes(data, end);
+    const char *p = data;
+    while (p < end) {
+        const char *hash = findChar(p, end, '#');
+        if (!hash) {
+            break;
+        }
+        const char *lineEnd = findChar(hash, end, '\n');
+        const char *next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        // '#' 之前只能是行首空白
+        const char *lineStart = hash;
+        while (lineStart > data && lineStart[-1] != '\n' && isTrimChar(lineStart[-1])) {
+            lineStart--;
+        }
+        if ((lineStart == data || lineStart[-1] == '\n') && !quotes.insideAt(lineStart)) {
+            const char *b = hash;
+            const char *e = lineEnd;
+            trimRange(b, e);
+            TopicsSection type = rangeEquals(b, e, "#TOPICS") ? TopicsSection::Topics
+                               : rangeEquals(b, e, "#OPTIONS") ? TopicsSection::Options
+                               : rangeEquals(b, e, "#VOTES") ? TopicsSection::Votes
+                               : TopicsSection::None;
+            if (type != TopicsSection::None) {
+                current.end = lineStart;
+                sections.push_back(current);
+                current.type = type;
+                current.begin = next;
+                current.end = end;
+            }
+        }
+        // 同一行中后面的 '#' 不可能是段标记
+        p = next;
+    }
+    sections.push_back(current);
+    return sections;
+}
+
+// 整数字段：未加引号时直接解析原始数据，加引号时先还原
+bool parseIntField(const CsvField &field, int &value, string &scratch) {
+    if (!field.quoted) {
+        return VoteParser::parseInt(field.begin, field.end, value) != nullptr;
+    }
+    CsvCodec::decode(field, scratch);
+    return VoteParser::parseInt(scratch.data(), scratch.data() + scratch.size(), value) != nullptr;
+}
 
-        if (line == "#TOPICS") { sec = Section::Topics; continue; }
-        if (line == "#OPTIONS") { sec = Section::Options; continue; }
-        if (line == "#VOTES") { sec = Section::Votes; continue; }
+bool parseInt64Field(const CsvField &field, long long &value, string &scratch) {
+    if (!field.quoted) {
+        return VoteParser::parseInt64(field.begin, field.end, value) != nullptr;
+    }
+    CsvCodec::decode(field, scratch);
+    return VoteParser::parseInt64(scratch.data(), scratch.data() + scratch.size(), value) != nullptr;
+}
 
-        // skip header lines
-        if (line.rfind("topicId,", 0) == 0) continue;
+/**
+ * 解析 #VOTES 段：每条记录 topicId,voterId,optionId,votedAt（多余的列忽略）
+ * 整数字段规则与 stoi/stoll 相同；表头、空行与格式错误的记录跳过
+ */
+void parseVoteRange(const char *b, const char *e, VoteColumns &out) {
+    CsvReader reader(b, static_cast<size_t>(e - b));
+    CsvField fields[4];
+    string scratch;
+    while (size_t count = reader.next(fields, 4)) {
+        int tid = 0, oid = 0;
+        long long ts = 0;
+        if (count < 4 || !parseIntField(fields[0], tid, scratch) ||
+            !parseIntField(fields[2], oid, scratch) || !parseInt64Field(fields[3], ts, scratch)) {
+            continue;
+        }
+        out.topicIds.push_back(tid);
+        out.optionIds.push_back(oid);
+        out.votedAt.push_back(ts);
+        if (fields[1].quoted) {
+            CsvCodec::decode(fields[1], scratch);
+            out.voterIds.append(scratch);
+        } else {
+            out.voterIds.append(fields[1].begin, fields[1].end);
+        }
+        out.voterEnds.push_back(out.voterIds.size());
+    }
+}
 
-        auto cols = splitCsv(line);
-        try {
-            if (sec == Section::Topics) {
-                if (cols.size() < 5) continue;
+// 把 [begin, end) 按大约 pieceBytes 切成以整条记录为边界的若干块（引号字段内的换行不作为切点）
+void splitRecords(const char *begin, const char *end, size_t pieceBytes, vector<std::pair<const char*, const char*>> &pieces) {
+    QuoteParity quotes(begin, end);
+    while (begin < end) {
+        const char *cut = end;
+        if (static_cast<size_t>(end - begin) > pieceBytes) {
+            const char *newline = findChar(begin + pieceBytes, end, '\n');
+            while (newline && quotes.insideAt(newline)) {
+                newline = findChar(newline + 1, end, '\n');
+            }
+            cut = newline ? newline + 1 : end;
+        }
+        pieces.push_back(std::make_pair(begin, cut));
+        begin = cut;
+    }
+}
+
+// 话题、选项记录用到的最多字段数，其后的列忽略
+const size_t kMaxRecordFields = 5;
+
+void decodeRecord(const CsvField *fields, size_t count, vector<string> &cols) {
+    cols.resize(std::min(count, kMaxRecordFields));
+    for (size_t i = 0; i < cols.size(); i++) {
+        CsvCodec::decode(fields[i], cols[i]);
+    }
+}
+
+// #TOPICS 段的一条记录：topicId,title,description,createdAt,votesPerVoter；表头与格式错误的记录返回 false
+bool parseTopicRow(const vector<string> &cols, VoteTopic &t) {
+    if (cols.size() < 5) return false;
+    try {
+        t.id = std::stoi(cols[0]);
+        t.title = cols[1];
+        t.description = cols[2];
+        t.createdAt = static_cast<time_t>(std::stoll(cols[3]));
+        t.votesPerVoter = std::stoi(cols[4]);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// #OPTIONS 段的一条记录：topicId,optionId,text,voteCount
+bool parseOptionRow(const vector<string> &cols, int &tid, VoteOption &opt) {
+    if (cols.size() < 4) return false;
+    try {
+        tid = std::stoi(cols[0]);
+        opt.id = std::stoi(cols[1]);
+        opt.text = cols[2];
+        opt.voteCount = std::stoi(cols[3]);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool importTopicsBuffer(const char *data, size_t size, vector<VoteTopic> &topics,
+                        vector<TopicVoteRecord> &voteHistory, unsigned threadCount) {
+    topics.clear();
+    voteHistory.clear();
+    vector<SectionRange> sections = findSections(data, size);
+
+    // #VOTES 段切成以整条记录为边界的块，多个线程各自解析到自己的列缓冲区
+    size_t voteBytes = 0;
+    for (const auto &sec : sections) {
+        if (sec.type == TopicsSection::Votes) voteBytes += static_cast<size_t>(sec.end - sec.begin);
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t workers = threadCount;
+    workers = std::max<size_t>(1, std::min(workers, voteBytes / kMinVoteBytesPerThread));
+    vector<std::pair<const char*, const char*>> pieces;
+    size_t pieceBytes = std::max<size_t>(kMinVoteBytesPerThread, voteBytes / (workers * 4) + 1);
+    for (const auto &sec : sections) {
+        if (sec.type == TopicsSection::Votes) splitRecords(sec.begin, sec.end, pieceBytes, pieces);
+    }
+    vector<VoteColumns> columns(pieces.size());
+    std::atomic<size_t> nextPiece(0);
+    auto parsePieces = [&]() {
+        for (size_t i = nextPiece++; i < pieces.size(); i = nextPiece++) {
+            parseVoteRange(pieces[i].first, pieces[i].second, columns[i]);
+        }
+    };
+    vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) {
+        threads.push_back(std::thread(parsePieces));
+    }
+
+    // 话题与选项段通常很小，在当前线程按文件顺序解析（选项只归入在它之前出现的话题）
+    unordered_map<int, size_t> tidToIdx;
+    CsvField fields[kMaxRecordFields];
+    vector<string> cols;
+    for (const auto &sec : sections) {
+        if (sec.type != TopicsSection::Topics && sec.type != TopicsSection::Options) {
+            continue;
+        }
+        CsvReader reader(sec.begin, static_cast<size_t>(sec.end - sec.begin));
+        while (size_t count = reader.next(fields, kMaxRecordFields)) {
+            decodeRecord(fields, count, cols);
+            if (sec.type == TopicsSection::Topics) {
                 VoteTopic t;
-                t.id = std::stoi(cols[0]);
-                t.title = cols[1];
-                t.description = cols[2];
-                t.createdAt = static_cast<time_t>(std::stoll(cols[3]));
-                t.votesPerVoter = std::stoi(cols[4]);
+                if (!parseTopicRow(cols, t)) continue;
                 topics.push_back(t);
                 tidToIdx[t.id] = topics.size() - 1;
-            } else if (sec == Section::Options) {
-                if (cols.size() < 4) continue;
-                int tid = std::stoi(cols[0]);
-                int oid = std::stoi(cols[1]);
-                string text = cols[2];
-                int vc = std::stoi(cols[3]);
-                if (!tidToIdx.count(tid)) continue;
+            } else {
+                int tid = 0;
                 VoteOption opt;
-                opt.id = oid;
-                opt.text = text;
-                opt.voteCount = vc;
+                if (!parseOptionRow(cols, tid, opt) || !tidToIdx.count(tid)) continue;
                 topics[tidToIdx[tid]].options.push_back(opt);
-            } else if (sec == Section::Votes) {
-                if (cols.size() < 4) continue;
-                int tid = std::stoi(cols[0]);
-                string vid = cols[1];
-                int oid = std::stoi(cols[2]);
-                time_t ts = static_cast<time_t>(std::stoll(cols[3]));
-                voteHistory.push_back(TopicVoteRecord(tid, vid, oid, ts));
             }
-        } catch (...) {
-            continue;
         }
     }
 
-    file.close();
+    parsePieces();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // 按块顺序拼接：先求各块的输出起点，再由各线程把自己负责的块写入对应区间
+    vector<size_t> offsets(columns.size() + 1, 0);
+    for (size_t i = 0; i < columns.size(); i++) {
+        offsets[i + 1] = offsets[i] + columns[i].topicIds.size();
+    }
+    voteHistory.resize(offsets.back());
+    nextPiece = 0;
+    auto fillPieces = [&]() {
+        for (size_t i = nextPiece++; i < columns.size(); i = nextPiece++) {
+            VoteColumns &col = columns[i];
+            size_t voterBegin = 0;
+            for (size_t k = 0; k < col.topicIds.size(); k++) {
+                TopicVoteRecord &rec = voteHistory[offsets[i] + k];
+                rec.topicId = col.topicIds[k];
+                rec.voterId.assign(col.voterIds, voterBegin, col.voterEnds[k] - voterBegin);
+                rec.optionId = col.optionIds[k];
+                rec.votedAt = static_cast<time_t>(col.votedAt[k]);
+                voterBegin = col.voterEnds[k];
+            }
+            col = VoteColumns();
+        }
+    };
+    threads.clear();
+    for (size_t w = 1; w < workers; w++) {
+        threads.push_back(std::thread(fillPieces));
+    }
+    fillPieces();
+    for (auto &t : threads) {
+        t.join();
+    }
+
     return !topics.empty();
 }
 
+} // namespace
+
+bool FileManager::importTopicsData(vector<VoteTopic> &topics,
+                                  vector<TopicVoteRecord> &voteHistory,
+                                  const string &filename,
+                                  unsigned threadCount) {
+    // 普通文件映射后直接解析；无法映射时（例如管道）按流读取
+    MappedFile mapped;
+    if (mapped.open(filename)) {
+        return importTopicsBuffer(mapped.data(), mapped.size(), topics, voteHistory, threadCount);
+    }
+
+    ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    bool ok = importTopicsData(topics, voteHistory, file, threadCount);
+    file.close();
+    return ok;
+}
+
+bool FileManager::importTopicsData(vector<VoteTopic> &topics,
+                                  vector<TopicVoteRecord> &voteHistory,
+                                  istream &file, unsigned threadCount) {
+    string data;
+    if (!readAll(file, data)) {
+        topics.clear();
+        voteHistory.clear();
+        return false;
+    }
+    return importTopicsBuffer(data.data(), data.size(), topics, voteHistory, threadCount);
+}
+
 
 bool FileManager::exportSingleTopicData(const VoteTopic &topic,
                                        const vector<TopicVoteRecord> &voteHistory,
                                        const string &filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
+    BufferedWriter file;
+    if (!file.open(filename, directOutput)) {
         return false;
     }
 
-    file << "#TOPICS\n";
-    file << "topicId,title,description,createdAt,votesPerVoter\n";
-    file << topic.id << ','
-         << topic.title << ','
-         << topic.description << ','
-         << static_cast<long long>(topic.createdAt) << ','
-         << topic.votesPerVoter << '\n';
+    writeTopicsHeader(file);
+    writeTopicRow(file, topic);
 
-    file << "#OPTIONS\n";
-    file << "topicId,optionId,text,voteCount\n";
-    for (const auto &opt : topic.options) {
-        file << topic.id << ','
-             << opt.id << ','
-             << opt.text << ','
-             << opt.voteCount << '\n';
-    }
+    writeOptionsHeader(file);
+    writeOptionRows(file, topic);
 
-    file << "#VOTES\n";
-    file << "topicId,voterId,optionId,votedAt\n";
+    writeVotesHeader(file);
     for (const auto &rec : voteHistory) {
         if (rec.topicId != topic.id) continue;
-        file << rec.topicId << ','
-             << rec.voterId << ','
-             << rec.optionId << ','
-             << static_cast<long long>(rec.votedAt) << '\n';
+        writeVoteRow(file, rec);
     }
 
-    file.close();
-    return true;
+    return file.close();
 }
 
 bool FileManager::importSingleTopicData(VoteTopic &topic,
                                        vector<TopicVoteRecord> &voteHistory,
                                        const string &filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
+    MappedFile mapped;
+    string buffer;
+    const char *data = nullptr;
+    size_t size = 0;
+    if (!loadFileData(filename, mapped, buffer, data, size)) {
         return false;
     }
 
@@ -476,71 +881,47 @@ bool FileManager::importSingleTopicData(VoteTopic &topic,
     topic.options.clear();
     voteHistory.clear();
 
-    string line;
-    enum class Section { None, Topics, Options, Votes };
-    Section sec = Section::None;
-
-    auto splitCsv = [](const string &s) {
-        vector<string> out;
-        string cur;
-        for (char ch : s) {
-            if (ch == ',') {
-                out.push_back(cur);
-                cur.clear();
+    // 只保留属于已解析话题的选项与投票（话题行出现之前的全部保留）
+    int parsedTopicId = -1;
+    CsvField fields[kMaxRecordFields];
+    vector<string> cols;
+    for (const auto &sec : findSections(data, size)) {
+        if (sec.type == TopicsSection::Votes) {
+            VoteColumns votes;
+            parseVoteRange(sec.begin, sec.end, votes);
+            size_t voterBegin = 0;
+            for (size_t k = 0; k < votes.topicIds.size(); k++) {
+                size_t voterEnd = votes.voterEnds[k];
+                if (parsedTopicId == -1 || votes.topicIds[k] == parsedTopicId) {
+                    voteHistory.push_back(TopicVoteRecord(votes.topicIds[k], votes.voterIds.substr(voterBegin, voterEnd - voterBegin),
+                                                          votes.optionIds[k], static_cast<time_t>(votes.votedAt[k])));
+                }
+                voterBegin = voterEnd;
+            }
+            continue;
+        }
+        if (sec.type == TopicsSection::None) {
+            continue;
+        }
+        CsvReader reader(sec.begin, static_cast<size_t>(sec.end - sec.begin));
+        while (size_t count = reader.next(fields, kMaxRecordFields)) {
+            decodeRecord(fields, count, cols);
+            if (sec.type == TopicsSection::Topics) {
+                VoteTopic t;
+                if (!parseTopicRow(cols, t)) continue;
+                t.options = topic.options;
+                topic = t;
+                parsedTopicId = topic.id;
             } else {
-                cur.push_back(ch);
+                int tid = 0;
+                VoteOption opt;
+                if (!parseOptionRow(cols, tid, opt)) continue;
+                if (parsedTopicId != -1 && tid != parsedTopicId) continue;
+                topic.options.push_back(opt);
             }
         }
-        out.push_back(cur);
-        return out;
-    };
-
-    int parsedTopicId = -1;
+    }
 
-    while (std::getline(file, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-
-        if (line == "#TOPICS") { sec = Section::Topics; continue; }
-        if (line == "#OPTIONS") { sec = Section::Options; continue; }
-        if (line == "#VOTES") { sec = Section::Votes; continue; }
-
-        if (line.rfind("topicId,", 0) == 0) continue;
-
-        auto cols = splitCsv(line);
-        try {
-            if (sec == Section::Topics) {
-                if (cols.size() < 5) continue;
-                topic.id = std::stoi(cols[0]);
-                parsedTopicId = topic.id;
-                topic.title = cols[1];
-                topic.description = cols[2];
-                topic.createdAt = static_cast<time_t>(std::stoll(cols[3]));
-                topic.votesPerVoter = std::stoi(cols[4]);
-            } else if (sec == Section::Options) {
-                if (cols.size() < 4) continue;
-                int tid = std::stoi(cols[0]);
-                if (parsedTopicId != -1 && tid != parsedTopicId) continue;
-                VoteOption opt;
-                opt.id = std::stoi(cols[1]);
-                opt.text = cols[2];
-                opt.voteCount = std::stoi(cols[3]);
-                topic.options.push_back(opt);
-            } else if (sec == Section::Votes) {
-                if (cols.size() < 4) continue;
-                int tid = std::stoi(cols[0]);
-                if (parsedTopicId != -1 && tid != parsedTopicId) continue;
-                string vid = cols[1];
-                int oid = std::stoi(cols[2]);
-                time_t ts = static_cast<time_t>(std::stoll(cols[3]));
-                voteHistory.push_back(TopicVoteRecord(tid, vid, oid, ts));
-            }
-        } catch (...) {
-            continue;
-        }
-    }
-
-    file.close();
     return topic.id > 0 && topic.options.size() >= 2;
 }
 // ==================== 核心选举系统实现 ====================
@@ -556,17 +937,47 @@ bool ElectionSystem::addCandidate(int id, const string &name, const string &depa
     }
     
     // 检查ID是否重复
-    if (idToIndex.count(id)) {
+    if (idToIndex.contains(id)) {
         return false;
     }
     
-    candidates.push_back(Candidate(id, name, department));
-    updateIndexMap();
+    Candidate candidate(id, name, department);
+    candidate.sortKey = NameCollation::sortKey(name);
+    candidates.insert(std::move(candidate));
+    idToIndex.insert(id, static_cast<int>(candidates.size() - 1));
+    candidateStats.add(id, 0);
     return true;
 }
 
+size_t ElectionSystem::addCandidates(const vector<Candidate> &rows, vector<size_t> *rejectedRows) {
+    candidates.reserve(candidates.size() + rows.size());
+    size_t added = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Candidate &row = rows[i];
+        // 与 addCandidate 相同的校验；批内重复的ID只保留第一条
+        if (!DataValidator::validateCandidateID(row.id) ||
+            !DataValidator::validateName(row.name) ||
+            idToIndex.contains(row.id)) {
+            if (rejectedRows) rejectedRows->push_back(i);
+            continue;
+        }
+        Candidate candidate(row.id, row.name, row.department);
+        candidate.sortKey = NameCollation::sortKey(row.name);
+        candidates.insert(std::move(candidate));
+        idToIndex.insert(row.id, static_cast<int>(candidates.size() - 1));
+        candidateStats.add(row.id, 0);
+        added++;
+    }
+    if (added > 0 && !idToIndex.isDense()) {
+        // 逐个插入时可能因ID到达顺序过早退回哈希表，按最终ID范围重新选择一次表示方式
+        updateIndexMap();
+    }
+    return added;
+}
+
 bool ElectionSystem::modifyCandidate(int id, const string &newName, const string &newDepartment) {
-    if (!idToIndex.count(id)) {
+    int index = idToIndex.find(id);
+    if (index == AdaptiveIdIndex::npos) {
         return false;
     }
     
@@ -574,74 +985,431 @@ bool ElectionSystem::modifyCandidate(int id, const string &newName, const string
         return false;
     }
     
-    int index = idToIndex[id];
-    candidates[index].name = newName;
+    if (candidates[index].name != newName) {
+        candidates[index].name = newName;
+        candidates[index].sortKey = NameCollation::sortKey(newName);
+    }
     candidates[index].department = newDepartment;
     return true;
 }
 
 bool ElectionSystem::deleteCandidate(int id) {
-    if (!idToIndex.count(id)) {
+    int index = idToIndex.find(id);
+    if (index == AdaptiveIdIndex::npos) {
         return false;
     }
     
-    int index = idToIndex[id];
-    candidates.erase(candidates.begin() + index);
-    updateIndexMap();
+    candidateStats.remove(id);
+    // 最后一个候选人移入空位，只需修正它的下标，O(1)；添加顺序由槽位表的插入序号保留
+    candidates.eraseAt(static_cast<size_t>(index));
+    idToIndex.erase(id);
+    if (static_cast<size_t>(index) < candidates.size()) {
+        idToIndex.insert(candidates[index].id, index);
+    }
     return true;
 }
 
-void ElectionSystem::vote(const vector<int> &votes, bool resetExisting) {
+// 投票向量至少达到该长度（且不短于ID范围）时才走直方图内核，否则建计数数组不划算
+static const size_t kHistogramMinBallots = 1024;
+// 并行计票时每个线程至少分到的选票数，更小的批量直接走单线程
+static const size_t kParallelMinBallotsPerThread = 1u << 16;
+// 每个线程私有计数数组按缓存行（64字节 = 8 个 uint64_t）对齐填充，避免伪共享
+static const size_t kCountsPerCacheLine = 8;
+
+size_t ElectionSystem::tallyCountSlots() const {
+    return idToIndex.isDense() ? idToIndex.denseSlots().size() : candidates.size();
+}
+
+void ElectionSystem::tallyChunk(const int *votes, size_t begin, size_t end,
+                                uint64_t *counts, vector<size_t> &invalidPositions) const {
+    if (idToIndex.isDense()) {
+        // 稠密索引：直方图内核按 id - base 计数
+        size_t first = invalidPositions.size();
+        VoteHistogram::count(votes + begin, end - begin, idToIndex.denseBase(),
+                             idToIndex.denseSlots().size(), counts, &invalidPositions);
+        for (size_t k = first; k < invalidPositions.size(); k++) {
+            invalidPositions[k] += begin;
+        }
+        return;
+    }
+    // 稀疏索引：按候选人下标计数
+    for (size_t i = begin; i < end; i++) {
+        int index = idToIndex.find(votes[i]);
+        if (index != AdaptiveIdIndex::npos) {
+            counts[index]++;
+        } else {
+            invalidPositions.push_back(i);
+        }
+    }
+}
+
+// 得票数累加：计数来自64位直方图，超出 int 范围时饱和在 INT_MAX，不回绕
+static inline void addVoteCount(int &voteCount, uint64_t n) {
+    uint64_t room = static_cast<uint64_t>(INT_MAX - std::max(voteCount, 0));
+    voteCount = n > room ? INT_MAX : voteCount + static_cast<int>(n);
+}
+
+bool ElectionSystem::applyTallyCounts(const uint64_t *counts) {
+    if (!idToIndex.isDense()) {
+        for (size_t k = 0; k < candidates.size(); k++) {
+            addVoteCount(candidates[k].voteCount, counts[k]);
+        }
+        return false;
+    }
+    const vector<int> &slots = idToIndex.denseSlots();
+    bool hasHoles = false;
+    for (size_t k = 0; k < slots.size(); k++) {
+        if (counts[k] == 0) continue;
+        if (slots[k] != AdaptiveIdIndex::npos) {
+            addVoteCount(candidates[slots[k]].voteCount, counts[k]);
+        } else {
+            hasHoles = true;
+        }
+    }
+    return hasHoles;
+}
+
+void ElectionSystem::collectInvalidPositions(const int *votes, size_t count, vector<size_t> &positions) const {
+    positions.clear();
+    for (size_t i = 0; i < count; i++) {
+        if (idToIndex.find(votes[i]) == AdaptiveIdIndex::npos) {
+            positions.push_back(i);
+        }
+    }
+}
+
+void ElectionSystem::tallyBatch(const int *votes, size_t count, vector<size_t> &invalidPositions) {
+    invalidPositions.clear();
+    if (idToIndex.isDense() && count >= kHistogramMinBallots && count >= tallyCountSlots()) {
+        // 批量路径：先在紧凑计数数组上做直方图，再一次性合并到候选人得票数
+        vector<uint64_t> counts(tallyCountSlots(), 0);
+        tallyChunk(votes, 0, count, counts.data(), invalidPositions);
+        if (applyTallyCounts(counts.data())) {
+            // 范围内但不存在的ID（如已删除的候选人）同样是无效票，重新收集全部无效位置
+            collectInvalidPositions(votes, count, invalidPositions);
+        }
+        return;
+    }
+    // 校验与计票合并为一次遍历（在现有基础上累加）
+    for (size_t i = 0; i < count; i++) {
+        int index = idToIndex.find(votes[i]);
+        if (index != AdaptiveIdIndex::npos) {
+            addVoteCount(candidates[index].voteCount, 1);
+        } else {
+            invalidPositions.push_back(i);
+        }
+    }
+}
+
+void ElectionSystem::recordVoteHistory(const int *votes, size_t count) {
+    switch (historyRetention) {
+    case VoteHistoryRetention::Full:
+        voteHistory.insert(voteHistory.end(), votes, votes + count);
+        break;
+    case VoteHistoryRetention::Tail:
+        if (count >= historyTail) {
+            voteHistory.assign(votes + count - historyTail, votes + count);
+            break;
+        }
+        voteHistory.insert(voteHistory.end(), votes, votes + count);
+        // 超过两倍窗口时一次裁掉前面的部分，每张选票摊还 O(1)
+        if (voteHistory.size() >= 2 * historyTail) {
+            voteHistory.erase(voteHistory.begin(), voteHistory.end() - historyTail);
+        }
+        break;
+    case VoteHistoryRetention::None:
+        break;
+    }
+}
+
+void ElectionSystem::setVoteHistoryRetention(VoteHistoryRetention retention, size_t tailWindow) {
+    historyRetention = retention;
+    historyTail = tailWindow;
+    if (retention == VoteHistoryRetention::None) {
+        vector<int>().swap(voteHistory);
+    } else if (retention == VoteHistoryRetention::Tail && voteHistory.size() > historyTail) {
+        voteHistory.erase(voteHistory.begin(), voteHistory.end() - historyTail);
+        voteHistory.shrink_to_fit();
+    }
+}
+
+VoteTallyResult ElectionSystem::vote(const vector<int> &votes, bool resetExisting) {
     // 为了满足“除非主动清零，否则所有投票都累加”的需求，
     // 这里不再根据 resetExisting 清空数据，真正的清零操作由 resetVotes()/clearAll() 控制。
     (void)resetExisting; // 避免未使用参数告警
     
-    // 获取有效ID列表
-    vector<int> validIDs = getValidIDs();
+    VoteTallyResult result;
+    result.totalCount = votes.size();
+    tallyBatch(votes.data(), votes.size(), result.invalidPositions);
+    recordVoteHistory(votes.data(), votes.size());
+    // 批量计票后整体重建统计：O(n log n)（排名重建需要排序），与票数无关，低于逐票更新的开销
+    rebuildCandidateStats();
     
-    int invalidCount = DataValidator::validateVoteVector(votes, validIDs);
-    if (invalidCount > 0) {
-        cout << "⚠️  警告：发现 " << invalidCount << " 张无效选票！\n";
+    result.invalidCount = result.invalidPositions.size();
+    result.validCount = result.totalCount - result.invalidCount;
+    return result;
+}
+
+VoteTallyResult ElectionSystem::voteParallel(const vector<int> &votes, unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t maxUseful = std::max<size_t>(1, votes.size() / kParallelMinBallotsPerThread);
+    size_t workers = std::min<size_t>(threadCount, maxUseful);
+    if (workers <= 1) {
+        return vote(votes, false);
+    }
+
+    VoteTallyResult result;
+    result.totalCount = votes.size();
+
+    // 每个线程一份私有计数数组，长度向上取整到整缓存行，并额外留出一行隔开相邻分配
+    const size_t slotCount = tallyCountSlots();
+    const size_t stride = (slotCount + kCountsPerCacheLine - 1) / kCountsPerCacheLine * kCountsPerCacheLine
+                          + kCountsPerCacheLine;
+    vector<vector<uint64_t>> partials(workers, vector<uint64_t>(stride, 0));
+    vector<vector<size_t>> invalidParts(workers);
+
+    // 保留全部历史时先扩展历史记录，各线程把自己的分段按原顺序拷入，保证 undoLastVote 行为不变
+    const bool copyHistory = historyRetention == VoteHistoryRetention::Full;
+    const size_t historyBase = voteHistory.size();
+    if (copyHistory) {
+        voteHistory.resize(historyBase + votes.size());
+    }
+
+    const size_t chunk = (votes.size() + workers - 1) / workers;
+    auto work = [&](size_t w) {
+        size_t begin = w * chunk;
+        size_t end = std::min(votes.size(), begin + chunk);
+        if (begin >= end) return;
+        tallyChunk(votes.data(), begin, end, partials[w].data(), invalidParts[w]);
+        if (copyHistory) {
+            std::copy(votes.begin() + begin, votes.begin() + end, voteHistory.begin() + historyBase + begin);
+        }
+    };
+
+    vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) {
+        threads.push_back(std::thread(work, w));
     }
-    
-    // 统计投票（在现有基础上累加）
-    for (int voteID : votes) {
-        voteHistory.push_back(voteID);
-        if (idToIndex.count(voteID)) {
-            candidates[idToIndex[voteID]].voteCount++;
+    work(0);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // 合并各线程的部分计数与无效位置（分段有序，直接拼接即保持原顺序）
+    vector<uint64_t> &merged = partials[0];
+    for (size_t w = 1; w < workers; w++) {
+        for (size_t k = 0; k < slotCount; k++) {
+            merged[k] += partials[w][k];
         }
     }
+    for (size_t w = 0; w < workers; w++) {
+        result.invalidPositions.insert(result.invalidPositions.end(),
+                                       invalidParts[w].begin(), invalidParts[w].end());
+    }
+    if (applyTallyCounts(merged.data())) {
+        collectInvalidPositions(votes.data(), votes.size(), result.invalidPositions);
+    }
+    if (!copyHistory) {
+        recordVoteHistory(votes.data(), votes.size());
+    }
+    rebuildCandidateStats();
+
+    result.invalidCount = result.invalidPositions.size();
+    result.validCount = result.totalCount - result.invalidCount;
+    return result;
 }
 
 bool ElectionSystem::castVote(int candidateID) {
-    if (!idToIndex.count(candidateID)) {
+    int index = idToIndex.find(candidateID);
+    if (index == AdaptiveIdIndex::npos || candidates[index].voteCount == INT_MAX) {
         return false;
     }
     
-    candidates[idToIndex[candidateID]].voteCount++;
-    voteHistory.push_back(candidateID);
+    candidateStats.increment(candidateID);
+    candidates[index].voteCount++;
+    recordVoteHistory(&candidateID, 1);
     return true;
 }
 
-int ElectionSystem::findWinner() {
-    if (candidates.empty()) {
-        return -1;
+// 流式导入每批计票的选票数：批次足够大才能走直方图内核，又不至于占用过多内存
+static const size_t kImportBatchVotes = 1u << 16;
+
+bool ElectionSystem::importVotes(const string &filename, VoteTallyResult &result, size_t chunkBytes) {
+    ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
     }
-    
-    int totalVotes = Statistics::getTotalVotes(candidates);
-    if (totalVotes == 0) {
-        return -1;
+    return importVotes(file, getFileExtensionLower(filename) == "txt", result, chunkBytes);
+}
+
+bool ElectionSystem::importVotes(istream &in, bool textFormat, VoteTallyResult &result, size_t chunkBytes) {
+    result = VoteTallyResult();
+    vector<int> batch;
+    vector<size_t> invalid;
+    batch.reserve(kImportBatchVotes);
+
+    auto flush = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        tallyBatch(batch.data(), batch.size(), invalid);
+        for (size_t k = 0; k < invalid.size() && result.invalidPositions.size() < kMaxReportedInvalid; k++) {
+            result.invalidPositions.push_back(result.totalCount + invalid[k]);
+        }
+        result.invalidCount += invalid.size();
+        result.totalCount += batch.size();
+        recordVoteHistory(batch.data(), batch.size());
+        batch.clear();
+    };
+    auto sink = [&](int v) {
+        batch.push_back(v);
+        if (batch.size() == kImportBatchVotes) {
+            flush();
+        }
+    };
+
+    // 读线程预读下一块的同时解析当前块；跨块的行/token 由 VoteChunkParser 拼接
+    ChunkPrefetcher reader(in, chunkBytes);
+    VoteChunkParser parser(textFormat);
+    const char *data = nullptr;
+    size_t size = 0;
+    while (reader.next(data, size)) {
+        parser.feed(data, size, sink);
+    }
+    parser.finish(sink);
+    flush();
+    rebuildCandidateStats();
+
+    result.validCount = result.totalCount - result.invalidCount;
+    // CSV格式要求至少有一行（表头或数据）
+    return textFormat || reader.bytesConsumed() > 0;
+}
+
+int ElectionSystem::findWinner() const {
+    // 排名随每次投票/撤销增量维护，只需检查第一名是否严格过半
+    return candidateStats.leader();
+}
+
+vector<const Candidate*> ElectionSystem::getCandidatesByVotes(size_t k) const {
+    const VoteRanking &ranking = candidateStats.ranking();
+    size_t n = (k == 0 || k > ranking.size()) ? ranking.size() : k;
+    vector<const Candidate*> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int index = idToIndex.find(ranking.keyAt(i));
+        if (index != AdaptiveIdIndex::npos) {
+            result.push_back(&candidates[index]);
+        }
     }
-    
-    // 直接遍历查找超过半数的候选人
-    // 时间复杂度：O(n)，空间复杂度：O(1)
-    for (const auto &c : candidates) {
-        if (c.voteCount > totalVotes / 2) {
-            return c.id;
+    return result;
+}
+
+StreamingWinnerResult ElectionSystem::findWinnerStreaming(istream &in, bool textFormat) const {
+    StreamingWinnerResult result;
+    const bool checkRoster = !candidates.empty();
+    std::streampos start = in.tellg();
+
+    // 第一遍：Boyer-Moore 多数投票，只保留一个候选ID和一个计数器
+    int majority = -1;
+    long long counter = 0;
+    {
+        VoteStreamReader reader(in, textFormat);
+        int v = 0;
+        while (reader.next(v)) {
+            if (checkRoster && !idToIndex.contains(v)) {
+                result.invalidVotes++;
+                continue;
+            }
+            result.validVotes++;
+            if (counter == 0) {
+                majority = v;
+                counter = 1;
+            } else if (v == majority) {
+                counter++;
+            } else {
+                counter--;
+            }
         }
     }
-    
-    return -1; // 没有超过半数的候选人
+    // 计数器归零说明任何ID都不可能严格过半，无需第二遍
+    result.majorityCandidate = counter > 0 ? majority : -1;
+    if (result.majorityCandidate == -1) {
+        result.verified = true;
+        return result;
+    }
+
+    // 第二遍：回到流开头，统计候选ID的实际得票数
+    in.clear();
+    if (start == std::streampos(-1) || !in.seekg(start)) {
+        in.clear();
+        return result;
+    }
+    long long votesFor = 0;
+    VoteStreamReader reader(in, textFormat);
+    int v = 0;
+    while (reader.next(v)) {
+        if (v == majority) {
+            votesFor++;
+        }
+    }
+    result.verified = true;
+    result.candidateVotes = votesFor;
+    if (votesFor * 2 > result.validVotes) {
+        result.winnerID = majority;
+    }
+    return result;
+}
+
+bool ElectionSystem::findWinnerStreaming(const string &filename, StreamingWinnerResult &result) const {
+    bool textFormat = getFileExtensionLower(filename) == "txt";
+    MappedFile mapped;
+    if (mapped.open(filename)) {
+        // 映射的文件可直接重复扫描：两遍都在解析时计数，不生成投票数组
+        result = StreamingWinnerResult();
+        const bool checkRoster = !candidates.empty();
+        int majority = -1;
+        long long counter = 0;
+        VoteParser::parse(mapped.data(), mapped.size(), textFormat, [&](int v) {
+            if (checkRoster && !idToIndex.contains(v)) {
+                result.invalidVotes++;
+                return;
+            }
+            result.validVotes++;
+            if (counter == 0) {
+                majority = v;
+                counter = 1;
+            } else if (v == majority) {
+                counter++;
+            } else {
+                counter--;
+            }
+        });
+        result.verified = true;
+        result.majorityCandidate = counter > 0 ? majority : -1;
+        if (result.majorityCandidate == -1) {
+            return true;
+        }
+        long long votesFor = 0;
+        VoteParser::parse(mapped.data(), mapped.size(), textFormat, [&](int v) {
+            votesFor += v == majority;
+        });
+        result.candidateVotes = votesFor;
+        if (votesFor * 2 > result.validVotes) {
+            result.winnerID = majority;
+        }
+        return true;
+    }
+
+    ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    result = findWinnerStreaming(file, textFormat);
+    file.close();
+    return true;
 }
 
 bool ElectionSystem::undoLastVote() {
@@ -653,9 +1421,10 @@ bool ElectionSystem::undoLastVote() {
     voteHistory.pop_back();
     
     // 减少该候选人的得票数
-    if (idToIndex.count(lastVoteID)) {
-        int index = idToIndex[lastVoteID];
+    int index = idToIndex.find(lastVoteID);
+    if (index != AdaptiveIdIndex::npos) {
         if (candidates[index].voteCount > 0) {
+            candidateStats.decrement(lastVoteID);
             candidates[index].voteCount--;
         }
     }
@@ -680,20 +1449,21 @@ int ElectionSystem::undoLastVotes(int k) {
     return actualCount;
 }
 
-int ElectionSystem::createTopic(const string &title, const string &description, const vector<string> &optionTexts, int votesPerVoter) {
+bool ElectionSystem::buildTopic(const string &title, const string &description,
+                                const vector<string> &optionTexts, int votesPerVoter, VoteTopic &topic) {
     if (trim(title).empty()) {
-        return -1;
+        return false;
     }
     if (optionTexts.size() < 2) {
-        return -1;
+        return false;
     }
 
-    VoteTopic topic;
-    topic.id = nextTopicId++;
     topic.title = title;
     topic.description = description;
     topic.createdAt = time(nullptr);
     topic.votesPerVoter = votesPerVoter;
+    topic.options.clear();
+    topic.options.reserve(optionTexts.size());
 
     int nextOptionId = 1;
     for (const auto &optTextRaw : optionTexts) {
@@ -703,16 +1473,55 @@ int ElectionSystem::createTopic(const string &title, const string &description,
     }
 
     if (topic.options.size() < 2) {
-        return -1;
+        return false;
     }
 
     if (topic.votesPerVoter <= 0 || topic.votesPerVoter > static_cast<int>(topic.options.size())) {
+        return false;
+    }
+    rebuildTopicStats(topic);
+    return true;
+}
+
+int ElectionSystem::createTopic(const string &title, const string &description, const vector<string> &optionTexts, int votesPerVoter) {
+    VoteTopic topic;
+    if (!buildTopic(title, description, optionTexts, votesPerVoter, topic)) {
         return -1;
     }
+    topic.id = nextTopicId++;
+    topics.insert(std::move(topic));
+    topicIdToIndex[topics.back().id] = static_cast<int>(topics.size() - 1);
+    if (journal) {
+        journalTopic(topics.back());
+    }
+    return topics.back().id;
+}
 
-    topics.push_back(topic);
-    updateTopicIndexMap();
-    return topic.id;
+size_t ElectionSystem::createTopics(const vector<VoteTopic> &specs, vector<int> *createdIds) {
+    topics.reserve(topics.size() + specs.size());
+    topicIdToIndex.reserve(topics.size() + specs.size());
+    size_t created = 0;
+    vector<string> optionTexts;
+    for (const auto &spec : specs) {
+        optionTexts.clear();
+        for (const auto &opt : spec.options) {
+            optionTexts.push_back(opt.text);
+        }
+        VoteTopic topic;
+        if (!buildTopic(spec.title, spec.description, optionTexts, spec.votesPerVoter, topic)) {
+            if (createdIds) createdIds->push_back(-1);
+            continue;
+        }
+        topic.id = nextTopicId++;
+        topics.insert(std::move(topic));
+        topicIdToIndex[topics.back().id] = static_cast<int>(topics.size() - 1);
+        if (journal) {
+            journalTopic(topics.back());
+        }
+        if (createdIds) createdIds->push_back(topics.back().id);
+        created++;
+    }
+    return created;
 }
 
 bool ElectionSystem::deleteTopic(int topicId) {
@@ -720,18 +1529,40 @@ bool ElectionSystem::deleteTopic(int topicId) {
         return false;
     }
     int idx = topicIdToIndex[topicId];
-    topics.erase(topics.begin() + idx);
-    // 清理该话题的已投票记录
-    topicVotedUsers.erase(topicId);
-    updateTopicIndexMap();
+    // 最后一个话题移入空位，只需修正它的下标，O(1)；添加顺序由槽位表的插入序号保留
+    topics.eraseAt(static_cast<size_t>(idx));
+    topicIdToIndex.erase(topicId);
+    if (static_cast<size_t>(idx) < topics.size()) {
+        topicIdToIndex[topics[idx].id] = idx;
+    }
+    // 按该话题的投票历史清理投票人记录与历史本身，O(该话题票数)
+    auto hist = topicHistories.find(topicId);
+    if (hist != topicHistories.end()) {
+        hist->second.forEach([&](const TopicVoteEntry &entry) {
+            topicBallots.erase(topicId, entry.voter);
+        });
+        topicHistories.erase(hist);
+    }
+    if (journal) {
+        journalTopicEvent(JournalEvent::DeleteTopic, topicId);
+    }
     return true;
 }
 
 VoteTopic* ElectionSystem::queryTopic(int topicId) {
-    if (!topicIdToIndex.count(topicId)) {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
         return nullptr;
     }
-    return &topics[topicIdToIndex[topicId]];
+    return &topics[it->second];
+}
+
+ElectionSystem::TopicHandle ElectionSystem::getTopicHandle(int topicId) const {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return TopicHandle();
+    }
+    return topics.handleAt(it->second);
 }
 
 bool ElectionSystem::castTopicVote(int topicId, int optionId) {
@@ -740,23 +1571,86 @@ bool ElectionSystem::castTopicVote(int topicId, int optionId) {
         return false;
     }
 
-    for (auto &opt : topic->options) {
-        if (opt.id == optionId) {
-            opt.voteCount++;
-            return true;
-        }
+    VoteOption *opt = findOption(*topic, optionId);
+    if (!opt) {
+        return false;
     }
-    return false;
+    topic->stats.increment(optionId);
+    opt->voteCount++;
+    if (journal) {
+        journalTopicEvent(JournalEvent::AnonymousCast, topicId, optionId);
+    }
+    return true;
+}
+
+// 去除首尾空白；ID本身没有首尾空白时不复制
+static inline bool isTrimSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static const string& trimmedVoterId(const string &voterId, string &buffer) {
+    if (!voterId.empty() && !isTrimSpace(voterId.front()) && !isTrimSpace(voterId.back())) {
+        return voterId;
+    }
+    buffer = trim(voterId);
+    return buffer;
+}
+
+VoterHandle ElectionSystem::internVoter(const string &voterId) {
+    string buffer;
+    const string &vid = trimmedVoterId(voterId, buffer);
+    if (vid.empty()) {
+        return VoterDictionary::kNoVoter;
+    }
+    return voters.intern(vid);
+}
+
+VoterHandle ElectionSystem::findVoter(const string &voterId) const {
+    string buffer;
+    const string &vid = trimmedVoterId(voterId, buffer);
+    if (vid.empty()) {
+        return VoterDictionary::kNoVoter;
+    }
+    return voters.find(vid);
 }
 
 bool ElectionSystem::castTopicVote(int topicId, int optionId, const string &voterId) {
+    string buffer;
+    const string &vid = trimmedVoterId(voterId, buffer);
+    if (vid.empty()) {
+        return false;
+    }
+
+    VoterHandle voter = voters.find(vid);
+    if (voter == VoterDictionary::kNoVoter) {
+        // 新投票人：确认这一票有效后再登记，避免无效请求撑大字典
+        VoteTopic *topic = queryTopic(topicId);
+        if (!topic || topic->votesPerVoter <= 0 || !findOption(*topic, optionId)) {
+            return false;
+        }
+        voter = voters.intern(vid);
+    }
+    return castTopicVote(topicId, optionId, voter);
+}
+
+bool ElectionSystem::castTopicVote(int topicId, int optionId, VoterHandle voter) {
+    time_t now = time(nullptr);
+    if (!castTopicVoteAt(topicId, optionId, voter, now)) {
+        return false;
+    }
+    if (journal) {
+        journalVote(JournalEvent::Cast, topicId, optionId, now, voters.idOf(voter));
+    }
+    return true;
+}
+
+bool ElectionSystem::castTopicVoteAt(int topicId, int optionId, VoterHandle voter, time_t votedAt) {
     VoteTopic *topic = queryTopic(topicId);
     if (!topic) {
         return false;
     }
 
-    string vid = trim(voterId);
-    if (vid.empty()) {
+    if (!voters.contains(voter)) {
         return false;
     }
 
@@ -764,31 +1658,29 @@ bool ElectionSystem::castTopicVote(int topicId, int optionId, const string &vote
         return false;
     }
 
-    // topicId -> voterId -> set<optionId>
-    auto &voterMap = topicVotedUsers[topicId];
-    auto &optionSet = voterMap[vid];
+    VoteOption *opt = findOption(*topic, optionId);
+    if (!opt) {
+        return false;
+    }
+
+    // (topicId, 投票人句柄) -> 已投选项（按选项下标记录），一次探测
+    BallotState &ballot = topicBallots.findOrInsert(topicId, voter);
+    size_t slot = static_cast<size_t>(opt - topic->options.data());
 
     // 已投票数达到上限
-    if (static_cast<int>(optionSet.size()) >= topic->votesPerVoter) {
+    if (ballot.count() >= topic->votesPerVoter) {
         return false;
     }
 
     // 不允许重复投同一选项
-    if (optionSet.count(optionId)) {
+    if (!ballot.insert(slot)) {
         return false;
     }
 
-    for (auto &opt : topic->options) {
-        if (opt.id == optionId) {
-            opt.voteCount++;
-            optionSet.insert(optionId);
-            topicVoteHistory.push_back(TopicVoteRecord(topicId, vid, optionId, time(nullptr)));
-            return true;
-        }
-    }
-
-    // 选项不存在：回滚空记录（可选）
-    return false;
+    topic->stats.increment(optionId);
+    opt->voteCount++;
+    appendTopicVote(topicId, voter, optionId, votedAt);
+    return true;
 }
 
 
@@ -797,83 +1689,755 @@ int ElectionSystem::getTopicRemainingVotes(int topicId, const string &voterId) c
     if (itIdx == topicIdToIndex.end()) {
         return 0;
     }
-
     const VoteTopic &topic = topics[itIdx->second];
     if (topic.votesPerVoter <= 0) {
         return 0;
     }
-
-    string vid = trim(voterId);
-    if (vid.empty()) {
-        return topic.votesPerVoter;
-    }    auto itTopic = topicVotedUsers.find(topicId);
-    if (itTopic == topicVotedUsers.end()) {
+    // 未登记（或为空）的投票人尚未投过票
+    VoterHandle voter = findVoter(voterId);
+    if (voter == VoterDictionary::kNoVoter) {
         return topic.votesPerVoter;
     }
-    auto itVoter = itTopic->second.find(vid);
-    if (itVoter == itTopic->second.end()) {
+    return getTopicRemainingVotes(topicId, voter);
+}
+
+int ElectionSystem::getTopicRemainingVotes(int topicId, VoterHandle voter) const {
+    auto itIdx = topicIdToIndex.find(topicId);
+    if (itIdx == topicIdToIndex.end()) {
+        return 0;
+    }
+
+    const VoteTopic &topic = topics[itIdx->second];
+    if (topic.votesPerVoter <= 0) {
+        return 0;
+    }
+
+    const BallotState *ballot = topicBallots.find(topicId, voter);
+    if (!ballot) {
         return topic.votesPerVoter;
     }
 
-    int used = static_cast<int>(itVoter->second.size());
+    int used = ballot->count();
     int remain = topic.votesPerVoter - used;
     return remain < 0 ? 0 : remain;
 }
 
+TopicVoteLog& ElectionSystem::topicHistory(int topicId) {
+    auto it = topicHistories.find(topicId);
+    if (it == topicHistories.end()) {
+        it = topicHistories.emplace(topicId, TopicVoteLog(topicId)).first;
+        it->second.setCompression(historyCompression, historyUndoWindow);
+    }
+    return it->second;
+}
+
+vector<TopicVoteRecord> ElectionSystem::getTopicVoteHistory() const {
+    // 各话题内已按序号递增：以最小堆按全局序号归并各话题的游标，O(m log k)，k 为有投票的话题数
+    vector<TopicVoteLog::Cursor> cursors;
+    cursors.reserve(topicHistories.size());
+    typedef std::pair<uint64_t, size_t> HeapItem;
+    std::priority_queue<HeapItem, vector<HeapItem>, std::greater<HeapItem> > heap;
+    for (const auto &kv : topicHistories) {
+        if (!kv.second.empty()) {
+            cursors.emplace_back(kv.second);
+            heap.push(HeapItem(cursors.back().sequence(), cursors.size() - 1));
+        }
+    }
+
+    vector<TopicVoteRecord> records;
+    records.reserve(getTopicVoteCount());
+    while (!heap.empty()) {
+        size_t c = heap.top().second;
+        heap.pop();
+        TopicVoteLog::Cursor &cursor = cursors[c];
+        TopicVoteEntry entry = cursor.entry();
+        records.push_back(TopicVoteRecord(entry.topicId, voters.idOf(entry.voter), entry.optionId, entry.votedAt));
+        cursor.next();
+        if (cursor.valid()) {
+            heap.push(HeapItem(cursor.sequence(), c));
+        }
+    }
+    return records;
+}
+
+vector<TopicVoteRecord> ElectionSystem::getTopicVoteHistory(int topicId) const {
+    vector<TopicVoteRecord> records;
+    const TopicVoteLog *log = getTopicVoteLog(topicId);
+    if (!log) {
+        return records;
+    }
+    records.reserve(log->size());
+    log->forEach([&](const TopicVoteEntry &entry) {
+        records.push_back(TopicVoteRecord(entry.topicId, voters.idOf(entry.voter), entry.optionId, entry.votedAt));
+    });
+    return records;
+}
+
+size_t ElectionSystem::getTopicVoteCount() const {
+    size_t total = 0;
+    for (const auto &kv : topicHistories) {
+        total += kv.second.size();
+    }
+    return total;
+}
+
+const TopicVoteLog* ElectionSystem::getTopicVoteLog(int topicId) const {
+    auto it = topicHistories.find(topicId);
+    return it == topicHistories.end() ? nullptr : &it->second;
+}
+
+void ElectionSystem::setTopicHistoryCompression(bool enabled, size_t undoWindow) {
+    historyCompression = enabled;
+    historyUndoWindow = undoWindow;
+    for (auto &kv : topicHistories) {
+        kv.second.setCompression(enabled, undoWindow);
+    }
+}
 
 bool ElectionSystem::undoLastTopicVote(TopicVoteRecord *undone) {
-    if (topicVoteHistory.empty()) {
+    // 全局最近一次投票即各话题最后一条记录中序号最大者
+    TopicVoteLog *latest = nullptr;
+    uint64_t latestSeq = 0;
+    for (auto &kv : topicHistories) {
+        if (kv.second.empty()) {
+            continue;
+        }
+        uint64_t seq = kv.second.back().sequence;
+        if (!latest || seq > latestSeq) {
+            latest = &kv.second;
+            latestSeq = seq;
+        }
+    }
+    if (!latest) {
+        return false;
+    }
+    return undoLastTopicVote(latest->topic(), undone);
+}
+
+bool ElectionSystem::undoLastTopicVote(int topicId, TopicVoteRecord *undone) {
+    auto it = topicHistories.find(topicId);
+    if (it == topicHistories.end() || it->second.empty()) {
         return false;
     }
 
-    TopicVoteRecord rec = topicVoteHistory.back();
-    topicVoteHistory.pop_back();
+    TopicVoteEntry rec = it->second.back();
+    it->second.popBack();
 
     if (undone) {
-        *undone = rec;
+        *undone = TopicVoteRecord(rec.topicId, voters.idOf(rec.voter), rec.optionId, rec.votedAt);
+    }
+    revokeTopicVote(rec);
+    if (journal) {
+        journalTopicEvent(JournalEvent::Undo, topicId);
     }
+    return true;
+}
 
+void ElectionSystem::revokeTopicVote(const TopicVoteEntry &rec) {
     VoteTopic *topic = queryTopic(rec.topicId);
     if (!topic) {
-        return false;
+        return;
     }
 
     // 找到选项并减票
-    for (auto &opt : topic->options) {
-        if (opt.id == rec.optionId) {
-            if (opt.voteCount > 0) {
-                opt.voteCount--;
-            }
-            break;
-        }
+    VoteOption *opt = findOption(*topic, rec.optionId);
+    if (opt && opt->voteCount > 0) {
+        topic->stats.decrement(rec.optionId);
+        opt->voteCount--;
     }
 
     // 从投票人记录中移除该选项
-    auto itTopic = topicVotedUsers.find(rec.topicId);
-    if (itTopic != topicVotedUsers.end()) {
-        auto itVoter = itTopic->second.find(rec.voterId);
-        if (itVoter != itTopic->second.end()) {
-            itVoter->second.erase(rec.optionId);
-            if (itVoter->second.empty()) {
-                itTopic->second.erase(itVoter);
-            }
+    BallotState *ballot = topicBallots.find(rec.topicId, rec.voter);
+    if (ballot && opt) {
+        ballot->erase(static_cast<size_t>(opt - topic->options.data()));
+        if (ballot->empty()) {
+            topicBallots.erase(rec.topicId, rec.voter);
+        }
+    }
+}
+
+long long ElectionSystem::getTopicTotalVotes(int topicId) const {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return 0;
+    }
+    return topics[it->second].stats.total();
+}
+
+int ElectionSystem::getTopicMaxVotes(int topicId) const {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return 0;
+    }
+    return topics[it->second].stats.maxCount();
+}
+
+int ElectionSystem::getTopicWinner(int topicId) const {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return -1;
+    }
+    return topics[it->second].stats.leader();
+}
+
+vector<const VoteOption*> ElectionSystem::getTopicOptionsByVotes(int topicId, size_t k) const {
+    vector<const VoteOption*> result;
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return result;
+    }
+    const VoteTopic &topic = topics[it->second];
+    const VoteRanking &ranking = topic.stats.ranking();
+    size_t n = (k == 0 || k > ranking.size()) ? ranking.size() : k;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const VoteOption *opt = findOption(topic, ranking.keyAt(i));
+        if (opt) {
+            result.push_back(opt);
+        }
+    }
+    return result;
+}
+
+int ElectionSystem::getTopicOptionRank(int topicId, int optionId) const {
+    auto it = topicIdToIndex.find(topicId);
+    if (it == topicIdToIndex.end()) {
+        return 0;
+    }
+    return static_cast<int>(topics[it->second].stats.ranking().rankOf(optionId));
+}
+
+bool ElectionSystem::loadTopicsData(const vector<VoteTopic> &importedTopics,
+                                    const vector<TopicVoteRecord> &importedHistory) {
+    if (importedTopics.empty()) {
+        return false;
+    }
+
+    clearTopicState();
+    if (journal) {
+        journalTopicEvent(JournalEvent::Clear, 0);
+    }
+
+    // 一次性校验并建立索引：ID非法或重复的话题只保留第一条
+    topics.reserve(importedTopics.size());
+    topicIdToIndex.reserve(importedTopics.size());
+    for (const auto &t : importedTopics) {
+        if (t.id <= 0 || topicIdToIndex.count(t.id)) {
+            continue;
         }
-        if (itTopic->second.empty()) {
-            topicVotedUsers.erase(itTopic);
+        VoteTopic topic = t;
+        rebuildTopicStats(topic);
+        topics.insert(std::move(topic));
+        topicIdToIndex[t.id] = static_cast<int>(topics.size() - 1);
+    }
+
+    for (const auto &t : topics) {
+        if (t.id >= nextTopicId) {
+            nextTopicId = t.id + 1;
+        }
+    }
+    if (journal) {
+        for (const auto &t : topics) {
+            journalTopic(t);
         }
     }
 
+    // 根据投票记录重建投票人限制与历史；选项票数以导入数据为准
+    topicBallots.reserve(importedHistory.size());
+    for (const auto &rec : importedHistory) {
+        auto itIdx = topicIdToIndex.find(rec.topicId);
+        if (itIdx == topicIdToIndex.end()) {
+            continue;
+        }
+        restoreTopicVote(rec.topicId, topics[itIdx->second].optionIndex, rec.voterId, rec.optionId, rec.votedAt);
+    }
     return true;
 }
 
-int ElectionSystem::getTopicTotalVotes(int topicId) const {
-    if (!topicIdToIndex.count(topicId)) {
-        return 0;
+bool ElectionSystem::importTopic(const VoteTopic &importedTopic,
+                                 const vector<TopicVoteRecord> &importedHistory,
+                                 int newTopicId) {
+    if (newTopicId <= 0 || topicIdToIndex.count(newTopicId)) {
+        return false;
+    }
+    if (importedTopic.options.size() < 2 || importedTopic.votesPerVoter <= 0) {
+        return false;
     }
-    const VoteTopic &topic = topics[topicIdToIndex.at(topicId)];
-    int total = 0;
+
+    VoteTopic topic = importedTopic;
+    topic.id = newTopicId;
+    rebuildTopicStats(topic);
+    topics.insert(std::move(topic));
+    topicIdToIndex[newTopicId] = static_cast<int>(topics.size() - 1);
+    if (newTopicId >= nextTopicId) {
+        nextTopicId = newTopicId + 1;
+    }
+
+    if (journal) {
+        journalTopic(topics.back());
+    }
+
+    // 投票记录改写为新ID后追加，并恢复投票人限制；选项票数以导入数据为准，不重新计票
+    const AdaptiveIdIndex &optionIndex = topics.back().optionIndex;
+    topicBallots.reserve(topicBallots.size() + importedHistory.size());
+    topicHistory(newTopicId).reserve(importedHistory.size());
+    for (const auto &rec : importedHistory) {
+        restoreTopicVote(newTopicId, optionIndex, rec.voterId, rec.optionId, rec.votedAt);
+    }
+    return true;
+}
+
+void ElectionSystem::restoreTopicVote(int topicId, const AdaptiveIdIndex &optionIndex,
+                                      const string &voterId, int optionId, time_t votedAt) {
+    // 与 castTopicVote 相同：去掉首尾空白，空ID（无效记录）不登记
+    string buffer;
+    const string &vid = trimmedVoterId(voterId, buffer);
+    if (vid.empty()) {
+        return;
+    }
+    VoterHandle voter = voters.intern(vid);
+    int slot = optionIndex.find(optionId);
+    if (slot != AdaptiveIdIndex::npos) {
+        topicBallots.findOrInsert(topicId, voter).insert(static_cast<size_t>(slot));
+    }
+    appendTopicVote(topicId, voter, optionId, votedAt);
+    if (journal) {
+        journalVote(JournalEvent::RestoreVote, topicId, optionId, votedAt, vid);
+    }
+}
+
+void ElectionSystem::clearTopicState() {
+    topics.clear();
+    topicIdToIndex.clear();
+    topicBallots.clear();
+    topicHistories.clear();
+    nextVoteSequence = 0;
+    voters.clear();
+    nextTopicId = 1;
+}
+
+// ==================== 话题投票日志 ====================
+
+void ElectionSystem::journalTopic(const VoteTopic &topic) {
+    journalRecord.reset(JournalEvent::PutTopic);
+    journalRecord.putI32(topic.id);
+    journalRecord.putString(topic.title);
+    journalRecord.putString(topic.description);
+    journalRecord.putI64(static_cast<int64_t>(topic.createdAt));
+    journalRecord.putI32(topic.votesPerVoter);
+    journalRecord.putU32(static_cast<uint32_t>(topic.options.size()));
     for (const auto &opt : topic.options) {
-        total += opt.voteCount;
+        journalRecord.putI32(opt.id);
+        journalRecord.putString(opt.text);
+        journalRecord.putI32(opt.voteCount);
     }
-    return total;
+    journalRecord.putI32(nextTopicId);
+    journal->append(journalRecord);
+}
+
+void ElectionSystem::journalTopicEvent(JournalEvent event, int topicId, int optionId) {
+    journalRecord.reset(event);
+    if (event != JournalEvent::Clear) {
+        journalRecord.putI32(topicId);
+    }
+    if (event == JournalEvent::AnonymousCast) {
+        journalRecord.putI32(optionId);
+    }
+    journal->append(journalRecord);
+}
+
+void ElectionSystem::journalVote(JournalEvent event, int topicId, int optionId, time_t votedAt, const string &voterId) {
+    journalRecord.reset(event);
+    journalRecord.putI32(topicId);
+    journalRecord.putI32(optionId);
+    journalRecord.putI64(static_cast<int64_t>(votedAt));
+    journalRecord.putString(voterId);
+    journal->append(journalRecord);
+}
+
+bool ElectionSystem::applyJournalRecord(JournalDecoder &in) {
+    switch (in.type()) {
+    case JournalEvent::Clear:
+        if (!in.valid()) return false;
+        clearTopicState();
+        return true;
+
+    case JournalEvent::PutTopic: {
+        VoteTopic topic;
+        topic.id = in.getI32();
+        topic.title = in.getString();
+        topic.description = in.getString();
+        topic.createdAt = static_cast<time_t>(in.getI64());
+        topic.votesPerVoter = in.getI32();
+        uint32_t optionCount = in.getU32();
+        for (uint32_t i = 0; i < optionCount && in.good(); i++) {
+            VoteOption opt;
+            opt.id = in.getI32();
+            opt.text = in.getString();
+            opt.voteCount = in.getI32();
+            topic.options.push_back(opt);
+        }
+        int next = in.getI32();
+        if (!in.valid()) {
+            return false;
+        }
+        nextTopicId = next;
+        if (topicIdToIndex.count(topic.id)) {
+            return true;
+        }
+        rebuildTopicStats(topic);
+        topics.insert(std::move(topic));
+        topicIdToIndex[topics.back().id] = static_cast<int>(topics.size() - 1);
+        return true;
+    }
+
+    case JournalEvent::DeleteTopic: {
+        int topicId = in.getI32();
+        if (!in.valid()) return false;
+        deleteTopic(topicId);
+        return true;
+    }
+
+    case JournalEvent::AnonymousCast: {
+        int topicId = in.getI32();
+        int optionId = in.getI32();
+        if (!in.valid()) return false;
+        castTopicVote(topicId, optionId);
+        return true;
+    }
+
+    case JournalEvent::Undo: {
+        int topicId = in.getI32();
+        if (!in.valid()) return false;
+        undoLastTopicVote(topicId, nullptr);
+        return true;
+    }
+
+    case JournalEvent::Cast:
+    case JournalEvent::RestoreVote: {
+        int topicId = in.getI32();
+        int optionId = in.getI32();
+        time_t votedAt = static_cast<time_t>(in.getI64());
+        string voterId = in.getString();
+        if (!in.valid()) {
+            return false;
+        }
+        if (in.type() == JournalEvent::Cast) {
+            castTopicVoteAt(topicId, optionId, internVoter(voterId), votedAt);
+        } else if (const VoteTopic *topic = queryTopic(topicId)) {
+            restoreTopicVote(topicId, topic->optionIndex, voterId, optionId, votedAt);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+void ElectionSystem::journalAllTopics() {
+    journalTopicEvent(JournalEvent::Clear, 0);
+    // 按添加顺序写入，重放后话题列表顺序不变
+    for (size_t i : topics.insertionOrder()) {
+        journalTopic(topics[i]);
+    }
+    for (const auto &rec : getTopicVoteHistory()) {
+        journalVote(JournalEvent::RestoreVote, rec.topicId, rec.optionId, rec.votedAt, rec.voterId);
+    }
+}
+
+bool ElectionSystem::replayJournalFile(const string &path, uint64_t *validLength) {
+    closeJournal();
+    clearTopicState();
+    bool ok = VoteJournal::replay(path, [this](JournalDecoder &in) { return applyJournalRecord(in); },
+                                  validLength, nullptr, &journalSkipped);
+    if (!ok) {
+        clearTopicState();
+    }
+    return ok;
+}
+
+bool ElectionSystem::replayJournal(const string &path) {
+    uint64_t validLength = 0;
+    return replayJournalFile(path, &validLength);
+}
+
+bool ElectionSystem::openJournal(const string &path, const VoteJournal::Options &options) {
+    uint64_t validLength = 0;
+    if (!replayJournalFile(path, &validLength)) {
+        return false;
+    }
+
+    std::unique_ptr<VoteJournal> opened(new VoteJournal());
+    if (!opened->open(path, validLength, options)) {
+        return false;
+    }
+    journal = std::move(opened);
+    journalPath = path;
+    journalOptions = options;
+    return true;
+}
+
+bool ElectionSystem::compactJournal() {
+    if (!journal) {
+        return true;
+    }
+    if (!journal->sync()) {
+        return false;
+    }
+
+    // 先写临时文件；journalAllTopics 写入 journal，暂时把新日志换上
+    string tempPath = journalPath + ".compact";
+    std::unique_ptr<VoteJournal> compacted(new VoteJournal());
+    if (!compacted->open(tempPath, 0, journalOptions)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    journal.swap(compacted);
+    journalAllTopics();
+    bool ok = journal->sync();
+    journal->close();
+    uint64_t length = journal->length();
+    journal.swap(compacted);
+    if (!ok) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    journal->close();
+#ifdef _WIN32
+    std::remove(journalPath.c_str());    // Windows 上 rename 不覆盖已有文件
+#endif
+    if (std::rename(tempPath.c_str(), journalPath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        length = journal->length();     // 原日志未被替换，继续追加
+    }
+    if (!journal->open(journalPath, length, journalOptions)) {
+        journal.reset();
+        return false;
+    }
+    return true;
+}
+
+bool ElectionSystem::syncJournal() {
+    return !journal || journal->sync();
+}
+
+void ElectionSystem::closeJournal() {
+    if (journal) {
+        journal->close();
+        journal.reset();
+    }
+}
+
+// ==================== 话题状态快照 ====================
+
+namespace {
+
+// 话题与选项的定长记录；文本存放在字符串区，按偏移与长度引用
+struct SnapshotTopic {
+    int32_t id;
+    int32_t votesPerVoter;
+    int64_t createdAt;
+    uint64_t titleOffset;       // 标题之后紧接描述
+    uint32_t titleLength;
+    uint32_t descriptionLength;
+    uint64_t firstOption;
+    uint32_t optionCount;
+    uint32_t reserved;
+};
+
+struct SnapshotOption {
+    int32_t id;
+    int32_t voteCount;
+    uint64_t textOffset;
+    uint32_t textLength;
+    uint32_t reserved;
+};
+
+} // namespace
+
+// 正文布局：话题ID与投票序号计数器、话题、选项、字符串区、投票人字典、投票人限制表、各话题投票历史
+bool ElectionSystem::saveSnapshot(const string &path) const {
+    SnapshotWriter out;
+    if (!out.open(path)) {
+        return false;
+    }
+    out.writeValue<int64_t>(nextTopicId);
+    out.writeValue<uint64_t>(nextVoteSequence);
+
+    vector<SnapshotTopic> topicRecords;
+    vector<SnapshotOption> optionRecords;
+    string strings;
+    topicRecords.reserve(topics.size());
+    // 按添加顺序保存，载入后话题列表顺序不变
+    for (size_t i : topics.insertionOrder()) {
+        const VoteTopic &t = topics[i];
+        SnapshotTopic rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.id = t.id;
+        rec.votesPerVoter = t.votesPerVoter;
+        rec.createdAt = static_cast<int64_t>(t.createdAt);
+        rec.titleOffset = strings.size();
+        rec.titleLength = static_cast<uint32_t>(t.title.size());
+        rec.descriptionLength = static_cast<uint32_t>(t.description.size());
+        strings += t.title;
+        strings += t.description;
+        rec.firstOption = optionRecords.size();
+        rec.optionCount = static_cast<uint32_t>(t.options.size());
+        for (const auto &opt : t.options) {
+            SnapshotOption o;
+            std::memset(&o, 0, sizeof(o));
+            o.id = opt.id;
+            o.voteCount = opt.voteCount;
+            o.textOffset = strings.size();
+            o.textLength = static_cast<uint32_t>(opt.text.size());
+            strings += opt.text;
+            optionRecords.push_back(o);
+        }
+        topicRecords.push_back(rec);
+    }
+    out.writeArray(topicRecords);
+    out.writeArray(optionRecords);
+    out.writeArray(strings.data(), strings.size());
+
+    // 投票人字典整体保存，载入后句柄不变
+    voters.saveSnapshot(out);
+    topicBallots.saveSnapshot(out);
+
+    out.writeValue<uint64_t>(topicHistories.size());
+    for (const auto &kv : topicHistories) {
+        out.writeValue<int64_t>(kv.first);
+        kv.second.saveSnapshot(out);
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.topicCount = topics.size();
+    header.voterCount = voters.size();
+    header.voteCount = getTopicVoteCount();
+    return out.good() && out.commit(header);
+}
+
+bool ElectionSystem::loadSnapshot(const string &path, bool verifyChecksum) {
+    MappedFile file;
+    if (!file.open(path) || !SnapshotFormat::check(file.data(), file.size(), verifyChecksum)) {
+        return false;
+    }
+    SnapshotReader in(file.data() + sizeof(SnapshotHeader), file.size() - sizeof(SnapshotHeader));
+
+    int64_t savedNextTopicId = 0;
+    uint64_t savedNextSequence = 0;
+    in.readValue(savedNextTopicId);
+    in.readValue(savedNextSequence);
+
+    uint64_t topicCount = 0, optionCount = 0, stringSize = 0;
+    const SnapshotTopic *topicRecords = in.readArray<SnapshotTopic>(topicCount);
+    const SnapshotOption *optionRecords = in.readArray<SnapshotOption>(optionCount);
+    const char *strings = in.readArray<char>(stringSize);
+    if (!in.good()) {
+        return false;
+    }
+
+    // 先载入到临时容器，全部成功后再替换现有数据
+    vector<VoteTopic> newTopics;
+    unordered_map<int, int> newTopicIndex;
+    newTopics.reserve(static_cast<size_t>(topicCount));
+    newTopicIndex.reserve(static_cast<size_t>(topicCount));
+    int64_t maxTopicId = 0;
+    for (uint64_t i = 0; i < topicCount; i++) {
+        const SnapshotTopic &rec = topicRecords[i];
+        if (rec.id <= 0 || newTopicIndex.count(rec.id) ||
+            rec.titleOffset > stringSize || rec.titleLength + static_cast<uint64_t>(rec.descriptionLength) > stringSize - rec.titleOffset ||
+            rec.firstOption > optionCount || rec.optionCount > optionCount - rec.firstOption) {
+            return false;
+        }
+        VoteTopic topic;
+        topic.id = rec.id;
+        topic.votesPerVoter = rec.votesPerVoter;
+        topic.createdAt = static_cast<time_t>(rec.createdAt);
+        topic.title.assign(strings + rec.titleOffset, rec.titleLength);
+        topic.description.assign(strings + rec.titleOffset + rec.titleLength, rec.descriptionLength);
+        topic.options.reserve(rec.optionCount);
+        for (uint32_t k = 0; k < rec.optionCount; k++) {
+            const SnapshotOption &o = optionRecords[rec.firstOption + k];
+            if (o.textOffset > stringSize || o.textLength > stringSize - o.textOffset) {
+                return false;
+            }
+            VoteOption opt(o.id, string(strings + o.textOffset, o.textLength));
+            opt.voteCount = o.voteCount;
+            topic.options.push_back(opt);
+        }
+        rebuildTopicStats(topic);
+        newTopics.push_back(std::move(topic));
+        newTopicIndex[rec.id] = static_cast<int>(newTopics.size() - 1);
+        maxTopicId = std::max<int64_t>(maxTopicId, rec.id);
+    }
+    // 下一个话题ID须大于现有ID且在 int 范围内
+    if (savedNextTopicId <= maxTopicId || savedNextTopicId > INT_MAX) {
+        return false;
+    }
+
+    VoterDictionary newVoters;
+    if (!newVoters.loadSnapshot(in)) {
+        return false;
+    }
+
+    // 跳过校验和时文件内容未经确认：各结构载入时仍检查布局与投票人句柄，不会越界
+    BallotTable newBallots;
+    if (!newBallots.loadSnapshot(in, newVoters.size())) {
+        return false;
+    }
+    // 每条记录的话题须存在、已投下标须小于该话题的选项数（撤销、重新计票按下标访问选项）
+    bool ballotsValid = true;
+    newBallots.forEach([&](int topicId, VoterHandle, const BallotState &ballot) {
+        auto it = newTopicIndex.find(topicId);
+        if (it == newTopicIndex.end() || ballot.slotLimit() > newTopics[it->second].options.size()) {
+            ballotsValid = false;
+        }
+    });
+    if (!ballotsValid) {
+        return false;
+    }
+
+    unordered_map<int, TopicVoteLog> newHistories;
+    uint64_t historyCount = 0;
+    in.readValue(historyCount);
+    if (!in.good() || historyCount > topicCount) {
+        return false;
+    }
+    newHistories.reserve(static_cast<size_t>(historyCount));
+    for (uint64_t i = 0; i < historyCount; i++) {
+        int64_t topicId = 0;
+        in.readValue(topicId);
+        if (!in.good() || topicId <= 0 || topicId > INT_MAX ||
+            !newTopicIndex.count(static_cast<int>(topicId)) || newHistories.count(static_cast<int>(topicId))) {
+            return false;
+        }
+        TopicVoteLog &log = newHistories.emplace(static_cast<int>(topicId), TopicVoteLog(static_cast<int>(topicId))).first->second;
+        if (!log.loadSnapshot(in, newVoters.size())) {
+            return false;
+        }
+        log.setCompression(historyCompression, historyUndoWindow);
+    }
+    if (!in.good() || !in.atEnd()) {
+        return false;
+    }
+
+    // 在现有槽位表中清空后重新插入：清空使所有槽位的代数加一，载入前取得的话题句柄随之失效
+    topics.clear();
+    topicIdToIndex.clear();
+    topics.reserve(newTopics.size());
+    for (auto &t : newTopics) {
+        topicIdToIndex[t.id] = static_cast<int>(topics.size());
+        topics.insert(std::move(t));
+    }
+    voters = std::move(newVoters);
+    topicBallots = std::move(newBallots);
+    topicHistories.swap(newHistories);
+    nextTopicId = static_cast<int>(savedNextTopicId);
+    nextVoteSequence = savedNextSequence;
+    // 快照取代了日志中此前的全部内容：压缩为快照状态；压缩失败时退回为在原日志末尾追加完整状态
+    if (journal && !compactJournal() && journal) {
+        journalAllTopics();
+    }
+    return true;
 }
@@ -13,9 +13,25 @@
 #include <QElapsedTimer>
 #include <QStackedLayout>
 #include <QInputDialog>
+#include <QTimer>
+#include <QStandardPaths>
+#include <QDir>
 #include <sstream>
 #include <iomanip>
 
+// 话题投票日志路径：环境变量 ELECTION_JOURNAL 指定时使用该路径，否则放在当前用户的应用数据目录
+static QString topicJournalPath() {
+    QByteArray custom = qgetenv("ELECTION_JOURNAL");
+    if (!custom.isEmpty()) {
+        return QFile::decodeName(custom);
+    }
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (dir.isEmpty() || !QDir().mkpath(dir)) {
+        return "topic_votes.journal";
+    }
+    return QDir(dir).filePath("topic_votes.journal");
+}
+
 static int getSelectedTopicIdFromTable(QTableWidget *table) {
     if (!table) return -1;
     QList<QTableWidgetItem*> items = table->selectedItems();
@@ -51,7 +67,8 @@ MainWindow::MainWindow(QWidget *parent)
       fontResetBtn(nullptr),
       fontUpBtn(nullptr),
       baseFontPointSize(13),
-      currentFontDelta(0)
+      currentFontDelta(0),
+      journalErrorReported(false)
 {
     setWindowTitle("投票选举管理系统 v2.0 - GUI版");
     setMinimumSize(1000, 700);
@@ -63,15 +80,69 @@ MainWindow::MainWindow(QWidget *parent)
     createCentralWidget();
     applyGlobalStyle();
     applyFontScale();
-    
-    statusLabel->setText("就绪");
+
+    // 重放话题投票日志：恢复上次运行（包括异常退出前）的话题与投票，之后的话题操作继续写入日志
+    journalPath = topicJournalPath();
+    if (electionSystem->openJournal(QFile::encodeName(journalPath).toStdString())) {
+        // 把上次运行追加的记录合并为当前状态，日志不随运行次数增长
+        compactTopicJournal();
+        updateTopicTable();
+        refreshTopicComboBox();
+        refreshAdminTopicSelectors();
+        refreshAdminViews();
+        updateVoterTopicOptionTable();
+        quint64 skipped = electionSystem->getJournalSkippedRecords();
+        if (skipped > 0) {
+            statusLabel->setText(QString("就绪（话题投票日志 %1 中有 %2 条记录无法识别，已跳过）").arg(journalPath).arg(skipped));
+        } else {
+            statusLabel->setText(QString("就绪（话题投票日志：%1）").arg(journalPath));
+        }
+    } else {
+        statusLabel->setText(QString("就绪（无法打开话题投票日志 %1，话题数据仅保存在内存中）").arg(journalPath));
+    }
+
+    // 日志由后台线程写入，写入失败不会在操作时返回错误：定时检查并提示
+    QTimer *journalTimer = new QTimer(this);
+    connect(journalTimer, &QTimer::timeout, this, &MainWindow::checkJournalStatus);
+    journalTimer->start(1000);
 }
 
 MainWindow::~MainWindow()
 {
+    if (!electionSystem->journalFailed()) {
+        compactTopicJournal();
+    }
     delete electionSystem;
 }
 
+void MainWindow::compactTopicJournal()
+{
+    if (!electionSystem->isJournaling() || electionSystem->getJournalSkippedRecords() > 0) {
+        return;
+    }
+    if (!electionSystem->compactJournal() && !electionSystem->isJournaling()) {
+        reportJournalError(QString("压缩后无法重新打开话题投票日志 %1，之后的话题操作不再保存到日志。").arg(journalPath));
+    }
+}
+
+void MainWindow::checkJournalStatus()
+{
+    if (electionSystem->journalFailed()) {
+        reportJournalError(QString("写入话题投票日志 %1 失败，之后的话题操作不再保存到日志，重新启动后将丢失。\n"
+                                   "请检查磁盘空间与文件权限，并及时导出话题数据。").arg(journalPath));
+    }
+}
+
+void MainWindow::reportJournalError(const QString &message)
+{
+    if (journalErrorReported) {
+        return;
+    }
+    journalErrorReported = true;
+    statusLabel->setText("话题投票日志写入失败，话题数据仅保存在内存中");
+    QMessageBox::warning(this, "话题投票日志", message);
+}
+
 void MainWindow::createMenus()
 {
     fileMenu = menuBar()->addMenu("文件(&F)");
@@ -917,7 +988,7 @@ void MainWindow::updateTopicStatisticsTable(int topicId) {
         return;
     }
 
-    int totalVotes = electionSystem->getTopicTotalVotes(topicId);
+    long long totalVotes = electionSystem->getTopicTotalVotes(topicId);
     statisticsTable->setColumnCount(5);
     statisticsTable->setHorizontalHeaderLabels(QStringList() << "选项ID" << "选项" << "票数" << "票率" << "每人可投N票");
     statisticsTable->setRowCount(static_cast<int>(topic->options.size()));
@@ -971,7 +1042,7 @@ void MainWindow::updateTopicResultView(int topicId) {
         return;
     }
 
-    int totalVotes = electionSystem->getTopicTotalVotes(topicId);
+    long long totalVotes = electionSystem->getTopicTotalVotes(topicId);
 
     QString html;
     html += QString("<h2>话题结果</h2>");
@@ -980,11 +1051,10 @@ void MainWindow::updateTopicResultView(int topicId) {
     html += QString("<p><b>每人可投票数(N)：</b>%1</p>").arg(topic->votesPerVoter);
     // 优胜者：得票率 > 50%
     if (totalVotes > 0) {
-        int winnerOptId = -1;
+        int winnerOptId = electionSystem->getTopicWinner(topicId);
         QString winnerOptText;
         for (const auto &opt : topic->options) {
-            if (opt.voteCount * 2 > totalVotes) {
-                winnerOptId = opt.id;
+            if (opt.id == winnerOptId) {
                 winnerOptText = QString::fromStdString(opt.text);
                 break;
             }
@@ -1001,10 +1071,8 @@ void MainWindow::updateTopicResultView(int topicId) {
     }
     html += "<hr>";
 
-    // 排序展示
-    vector<const VoteOption*> sorted;
-    for (const auto &opt : topic->options) sorted.push_back(&opt);
-    std::sort(sorted.begin(), sorted.end(), [](const VoteOption* a, const VoteOption* b){ return a->voteCount > b->voteCount; });
+    // 按名次展示（排名由系统增量维护，无需排序）
+    vector<const VoteOption*> sorted = electionSystem->getTopicOptionsByVotes(topicId);
 
     html += "<table border='1' cellpadding='5'>";
     html += "<tr><th>排名</th><th>选项ID</th><th>选项</th><th>票数</th><th>票率</th></tr>";
@@ -1031,7 +1099,7 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
         return;
     }
 
-    int totalVotes = electionSystem->getTopicTotalVotes(topicId);
+    long long totalVotes = electionSystem->getTopicTotalVotes(topicId);
 
     if (actionIndex == 0) {
         // 投票数据分析（按选项汇总）
@@ -1052,9 +1120,7 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
 
     if (actionIndex == 1) {
         // 排名分析
-        vector<const VoteOption*> sorted;
-        for (const auto &opt : topic->options) sorted.push_back(&opt);
-        std::sort(sorted.begin(), sorted.end(), [](const VoteOption* a, const VoteOption* b){ return a->voteCount > b->voteCount; });
+        vector<const VoteOption*> sorted = electionSystem->getTopicOptionsByVotes(topicId);
 
         QString txt;
         txt += "话题选项排名分析\n";
@@ -1077,8 +1143,7 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
 
     if (actionIndex == 2) {
         // 分布分析（条形）
-        int maxVotes = 0;
-        for (const auto &opt : topic->options) maxVotes = std::max(maxVotes, opt.voteCount);
+        int maxVotes = electionSystem->getTopicMaxVotes(topicId);
 
         QString txt;
         txt += "话题得票分布分析（可视化）\n";
@@ -1102,7 +1167,6 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
     const int loopsTotal = 20000;
     const int loopsSort = 2000;
     const int loopsVote = 2000;
-    const int loopsUndo = 2000;
 
     qint64 tTotalNs = 0;
     qint64 tSortNs = 0;
@@ -1111,41 +1175,40 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
 
     // 1) getTopicTotalVotes
     timer.start();
-    int sink = 0;
+    long long sink = 0;
     for (int i = 0; i < loopsTotal; ++i) {
         sink += electionSystem->getTopicTotalVotes(topicId);
     }
     tTotalNs = timer.nsecsElapsed();
 
-    // 2) 排序（按票数）
+    // 2) 按票数排名（读取增量维护的排名）
     timer.restart();
     for (int i = 0; i < loopsSort; ++i) {
-        vector<const VoteOption*> sorted;
-        sorted.reserve(topic->options.size());
-        for (const auto &opt : topic->options) sorted.push_back(&opt);
-        std::sort(sorted.begin(), sorted.end(), [](const VoteOption* a, const VoteOption* b){ return a->voteCount > b->voteCount; });
+        vector<const VoteOption*> sorted = electionSystem->getTopicOptionsByVotes(topicId);
         if (!sorted.empty()) sink += sorted[0]->voteCount;
     }
     tSortNs = timer.nsecsElapsed();
 
-    // 3) 投票：为了不破坏现有数据，投完马上撤销
+    // 3) 投票：在只含该话题副本的临时系统上进行，不写入话题投票日志，也不在投票人字典中留下测试ID
+    ElectionSystem scratch;
+    scratch.importTopic(*topic, vector<TopicVoteRecord>(), topicId);
     int optionIdForPerf = topic->options.empty() ? 1 : topic->options[0].id;
     timer.restart();
     int voted = 0;
     for (int i = 0; i < loopsVote; ++i) {
         QString vid = QString("perf_%1").arg(i);
-        if (electionSystem->castTopicVote(topicId, optionIdForPerf, vid.toStdString())) {
+        if (scratch.castTopicVote(topicId, optionIdForPerf, vid.toStdString())) {
             voted++;
         }
     }
     tVoteNs = timer.nsecsElapsed();
 
-    // 4) 撤销最近投票
+    // 4) 撤销刚才的投票（只撤销实际投出的票数）
     timer.restart();
     int undone = 0;
-    for (int i = 0; i < loopsUndo; ++i) {
+    for (int i = 0; i < voted; ++i) {
         TopicVoteRecord rec;
-        if (electionSystem->undoLastTopicVote(&rec)) {
+        if (scratch.undoLastTopicVote(&rec)) {
             undone++;
         } else {
             break;
@@ -1162,9 +1225,9 @@ void MainWindow::updateTopicAnalysisView(int topicId, int actionIndex) {
     txt += QString("选项数：%1，当前总票数：%2\n\n").arg(topic->options.size()).arg(totalVotes);
 
     txt += QString("1) getTopicTotalVotes 调用 %1 次：%2 ms\n").arg(loopsTotal).arg(nsToMs(tTotalNs), 0, 'f', 3);
-    txt += QString("2) 选项排序重复 %1 次：%2 ms\n").arg(loopsSort).arg(nsToMs(tSortNs), 0, 'f', 3);
+    txt += QString("2) 选项排名读取重复 %1 次：%2 ms\n").arg(loopsSort).arg(nsToMs(tSortNs), 0, 'f', 3);
     txt += QString("3) castTopicVote 尝试 %1 次（成功 %2 次）：%3 ms\n").arg(loopsVote).arg(voted).arg(nsToMs(tVoteNs), 0, 'f', 3);
-    txt += QString("4) undoLastTopicVote 执行 %1 次（成功 %2 次）：%3 ms\n").arg(loopsUndo).arg(undone).arg(nsToMs(tUndoNs), 0, 'f', 3);
+    txt += QString("4) undoLastTopicVote 执行 %1 次（成功 %2 次）：%3 ms\n").arg(voted).arg(undone).arg(nsToMs(tUndoNs), 0, 'f', 3);
 
     (void)sink;
     analysisText->setPlainText(txt);
@@ -1181,7 +1244,7 @@ void MainWindow::updateTopicTable() {
 
     for (size_t i = 0; i < topics.size(); i++) {
         const auto &t = topics[i];
-        int totalVotes = electionSystem->getTopicTotalVotes(t.id);
+        long long totalVotes = electionSystem->getTopicTotalVotes(t.id);
         QString created = t.createdAt > 0 ? QDateTime::fromSecsSinceEpoch(static_cast<qint64>(t.createdAt)).toString("yyyy-MM-dd hh:mm:ss") : "-";
 
         auto *idItem = new QTableWidgetItem(QString::number(t.id));
@@ -1254,7 +1317,7 @@ void MainWindow::updateVoterTopicOptionTable() {
         return;
     }
     
-    int totalVotes = electionSystem->getTopicTotalVotes(topicId);
+    long long totalVotes = electionSystem->getTopicTotalVotes(topicId);
     voterTopicOptionTable->setRowCount(static_cast<int>(topic->options.size()));
     
     for (size_t i = 0; i < topic->options.size(); i++) {
@@ -1298,7 +1361,7 @@ void MainWindow::showTopicResultDialog(int topicId) {
         return;
     }
     
-    int totalVotes = electionSystem->getTopicTotalVotes(topicId);
+    long long totalVotes = electionSystem->getTopicTotalVotes(topicId);
     
     QString message = QString("<h3>%1</h3>").arg(QString::fromStdString(topic->title));
     if (!topic->description.empty()) {
@@ -1309,11 +1372,10 @@ void MainWindow::showTopicResultDialog(int topicId) {
     // 优胜者：得票率 > 50%
     QString winnerLine;
     if (totalVotes > 0) {
-        int winnerOptId = -1;
+        int winnerOptId = electionSystem->getTopicWinner(topicId);
         QString winnerOptText;
         for (const auto &opt : topic->options) {
-            if (opt.voteCount * 2 > totalVotes) {
-                winnerOptId = opt.id;
+            if (opt.id == winnerOptId) {
                 winnerOptText = QString::fromStdString(opt.text);
                 break;
             }
@@ -1332,13 +1394,8 @@ void MainWindow::showTopicResultDialog(int topicId) {
     message += "<table border='1' cellspacing='0' cellpadding='5' style='width:100%'>";
     message += "<tr><th>选项ID</th><th>选项内容</th><th>票数</th><th>得票率</th></tr>";
     
-    // 按票数排序选项
-    vector<const VoteOption*> sortedOptions;
-    for (const auto& opt : topic->options) {
-        sortedOptions.push_back(&opt);
-    }
-    std::sort(sortedOptions.begin(), sortedOptions.end(), 
-             [](const VoteOption* a, const VoteOption* b) { return a->voteCount > b->voteCount; });
+    // 按票数名次排列选项
+    vector<const VoteOption*> sortedOptions = electionSystem->getTopicOptionsByVotes(topicId);
     
     for (const auto* opt : sortedOptions) {
         double percentage = (totalVotes > 0) ? (100.0 * opt->voteCount / totalVotes) : 0;
@@ -1562,17 +1619,10 @@ void MainWindow::onBatchVote()
         return;
     }
     
-    electionSystem->vote(votes, false);
+    VoteTallyResult tally = electionSystem->vote(votes, false);
     
     int totalVotes = static_cast<int>(votes.size()) + invalidTokens;
-    const vector<Candidate> &candidates = electionSystem->getAllCandidates();
-    vector<int> validIDList;
-    for (const auto &c : candidates) {
-        validIDList.push_back(c.id);
-    }
-    
-    int invalidCount = DataValidator::validateVoteVector(votes, validIDList);
-    int totalInvalid = invalidCount + invalidTokens;
+    int totalInvalid = static_cast<int>(tally.invalidCount) + invalidTokens;
     
     QString message = QString("批量投票完成！\n总票数: %1").arg(totalVotes);
     if (totalInvalid > 0) {
@@ -1597,17 +1647,20 @@ void MainWindow::onImportVotesFromFile()
         return;
     }
     
-    vector<int> votes;
-    if (FileManager::loadVotes(votes, filename.toStdString())) {
-        // 从文件导入视为一次批量投票，在当前票数基础上累加
-        electionSystem->vote(votes, false);
-        showMessage("成功", QString("成功从文件加载 %1 张选票").arg(votes.size()));
+    // 边读边计票，不把整个文件载入内存；从文件导入视为一次批量投票，在当前票数基础上累加
+    VoteTallyResult tally;
+    if (electionSystem->importVotes(filename.toStdString(), tally)) {
+        QString message = QString("成功从文件加载 %1 张选票").arg(tally.totalCount);
+        if (tally.invalidCount > 0) {
+            message += QString("\n无效票数: %1").arg(tally.invalidCount);
+        }
+        showMessage("成功", message);
         updateCandidateTable();
         updateStatisticsTable();
         // updateVoteHistoryList();
         onShowSummary();
         onShowElectionResult();
-        statusLabel->setText(QString("已从文件加载 %1 张选票").arg(votes.size()));
+        statusLabel->setText(QString("已从文件加载 %1 张选票").arg(tally.totalCount));
     } else {
         showMessage("错误", "文件加载失败！", true);
     }
@@ -1753,7 +1806,7 @@ void MainWindow::onShowElectionResult()
     }
     
     int winnerID = electionSystem->findWinner();
-    int totalVotes = Statistics::getTotalVotes(candidates);
+    long long totalVotes = electionSystem->getTotalVotes();
     
     QString result;
     result += "<h2>选举结果</h2>\n";
@@ -1777,20 +1830,19 @@ void MainWindow::onShowElectionResult()
         result += "<h3 style='color: red;'>❌ 没有候选人获得超过半数选票</h3>\n";
         result += "<p>所有候选人得票情况：</p>\n";
         
-        vector<Candidate> sorted = candidates;
-        Statistics::sortByVotes(sorted, false);
+        vector<const Candidate*> sorted = electionSystem->getCandidatesByVotes();
         
         result += "<table border='1' cellpadding='5'>\n";
         result += "<tr><th>排名</th><th>编号</th><th>姓名</th><th>得票数</th><th>得票率</th></tr>\n";
         
         for (size_t i = 0; i < sorted.size(); i++) {
             double percentage = totalVotes > 0 ? 
-                (100.0 * sorted[i].voteCount / totalVotes) : 0.0;
+                (100.0 * sorted[i]->voteCount / totalVotes) : 0.0;
             result += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5%</td></tr>\n")
                 .arg(i + 1)
-                .arg(sorted[i].id)
-                .arg(QString::fromStdString(sorted[i].name))
-                .arg(sorted[i].voteCount)
+                .arg(sorted[i]->id)
+                .arg(QString::fromStdString(sorted[i]->name))
+                .arg(sorted[i]->voteCount)
                 .arg(percentage, 0, 'f', 2);
         }
         result += "</table>\n";
@@ -1809,7 +1861,7 @@ void MainWindow::onExportReport()
     }
     
     int winnerID = electionSystem->findWinner();
-    if (FileManager::exportReport(electionSystem->getAllCandidates(), winnerID, filename.toStdString())) {
+    if (FileManager::exportReport(electionSystem->getCandidatesByVotes(), winnerID, filename.toStdString())) {
         showMessage("成功", QString("统计报告已导出到: %1").arg(filename));
         maintenanceLog->append(QString("[%1] 导出统计报告: %2")
                                .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"))
@@ -1843,7 +1895,7 @@ void MainWindow::onSaveCandidates()
         return;
     }
 
-    if (FileManager::exportSingleTopicData(*topic, electionSystem->getTopicVoteHistory(), filename.toStdString())) {
+    if (FileManager::exportSingleTopicData(*topic, electionSystem->getTopicVoteHistory(topicId), filename.toStdString())) {
         showMessage("成功", QString("话题已导出到: %1").arg(filename));
         if (maintenanceLog) {
             maintenanceLog->append(QString("[%1] 导出话题: %2 (topicId=%3)")
@@ -1888,44 +1940,18 @@ void MainWindow::onLoadCandidates()
         return;
     }
 
-    // 创建新话题（使用导入内容）
-    vector<string> optTexts;
-    optTexts.reserve(imported.options.size());
-    for (const auto &opt : imported.options) {
-        optTexts.push_back(opt.text);
-    }
-
-    int createdId = electionSystem->createTopic(imported.title, imported.description, optTexts, imported.votesPerVoter);
-    if (createdId <= 0) {
+    // 以指定ID导入：票数、创建时间、投票记录与投票人限制由系统一并恢复
+    if (!electionSystem->importTopic(imported, votes, newTopicId)) {
         showMessage("错误", "导入失败：创建话题失败。", true);
         return;
     }
 
-    VoteTopic *nt = electionSystem->queryTopic(createdId);
+    VoteTopic *nt = electionSystem->queryTopic(newTopicId);
     if (!nt) {
         showMessage("错误", "导入失败：内部错误。", true);
         return;
     }
 
-    // 覆盖为指定的新 topicId，并恢复 createdAt / voteCount
-    nt->id = newTopicId;
-    nt->createdAt = imported.createdAt;
-    nt->votesPerVoter = imported.votesPerVoter;
-    for (size_t i = 0; i < nt->options.size() && i < imported.options.size(); ++i) {
-        nt->options[i].voteCount = imported.options[i].voteCount;
-    }
-
-    // 追加投票记录：将 topicId 替换为 newTopicId
-    // 注意：这里仅用于导出记录展示，不用于重新构建投票人限制（限制基于内存中的 topicVotedUsers）
-    // 简单做法：重新播放投票记录以恢复限制与历史
-    for (auto &rec : votes) {
-        rec.topicId = newTopicId;
-        // 重新记录到系统历史中（不重复计票）
-        // 为保证一致性，这里不再计票，只把记录附加到历史
-    }
-
-    // 将投票记录直接附加到 topicVoteHistory（需要一个入口；目前只有 getter，这里先不恢复投票人限制，后续可补）
-
     showMessage("成功", QString("导入成功：话题ID %1（选项%2个）").arg(newTopicId).arg(nt->options.size()));
 
     updateTopicTable();
@@ -2034,8 +2060,7 @@ void MainWindow::onAnalyzeRanking()
         return;
     }
     
-    vector<Candidate> sorted = candidates;
-    Statistics::sortByVotes(sorted, false);
+    vector<const Candidate*> sorted = electionSystem->getCandidatesByVotes();
     
     QString analysis = "候选人排名分析\n";
     analysis += "═══════════════════════════════════════\n\n";
@@ -2045,9 +2070,9 @@ void MainWindow::onAnalyzeRanking()
     for (size_t i = 0; i < sorted.size(); i++) {
         analysis += QString("%1\t%2\t%3\t\t%4\n")
             .arg(i + 1)
-            .arg(sorted[i].id)
-            .arg(QString::fromStdString(sorted[i].name))
-            .arg(sorted[i].voteCount);
+            .arg(sorted[i]->id)
+            .arg(QString::fromStdString(sorted[i]->name))
+            .arg(sorted[i]->voteCount);
     }
     
     analysisText->setPlainText(analysis);
@@ -2068,7 +2093,7 @@ void MainWindow::onAnalyzeDistribution()
         return;
     }
     
-    int maxVotes = Statistics::getMaxVotes(candidates);
+    int maxVotes = electionSystem->getMaxVotes();
     
     QString analysis = "得票分布分析（可视化）\n";
     analysis += "═══════════════════════════════════════\n\n";
@@ -0,0 +1,85 @@
+#include "../include/mapped_file.h"
+
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ==================== 只读文件映射实现 ====================
+
+MappedFile::MappedFile() : base(nullptr), length(0), mapped(false) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(p, length, MADV_SEQUENTIAL);
+#endif
+    base = static_cast<const char*>(p);
+    mapped = true;
+    return true;
+#else
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size < 0) {
+        std::fclose(f);
+        return false;
+    }
+    // 以 uint64_t 为单位分配，保证正文数组按8字节对齐
+    fallback.resize((static_cast<size_t>(size) + 7) / 8);
+    bool ok = std::fread(fallback.data(), 1, static_cast<size_t>(size), f) == static_cast<size_t>(size);
+    std::fclose(f);
+    if (!ok) {
+        fallback.clear();
+        return false;
+    }
+    base = reinterpret_cast<const char*>(fallback.data());
+    length = static_cast<size_t>(size);
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped) {
+        munmap(const_cast<char*>(base), length);
+    }
+#endif
+    base = nullptr;
+    length = 0;
+    mapped = false;
+    std::vector<uint64_t>().swap(fallback);
+}
@@ -0,0 +1,304 @@
+#include "../include/name_collation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+
+#ifdef ELECTION_HAVE_ICONV
+#include <iconv.h>
+#endif
+
+// ==================== 姓名排序键与基数排序实现 ====================
+
+namespace {
+
+enum class Mode { Pinyin, Locale, Bytes };
+
+// 键的第一个字节：纯英文名排在其他名字之前
+const char kGroupEnglish = '\x01';
+const char kGroupOther = '\x02';
+// 不在 GB2312 中的字符统一以该字节开头，排在所有汉字之后
+const unsigned char kUnmappedPrefix = 0xFF;
+// 分段小于该长度时改用比较排序
+const size_t kRadixCutoff = 32;
+
+#ifdef ELECTION_HAVE_ICONV
+// 建立 Unicode(BMP) -> GB2312 区位码表；GB2312 一级汉字按拼音排列，二级汉字按部首排列
+bool buildGb2312Table(std::vector<uint16_t> &table) {
+    iconv_t cd = iconv_open("UTF-32LE", "GB2312");
+    if (cd == reinterpret_cast<iconv_t>(-1)) {
+        return false;
+    }
+    table.assign(0x10000, 0);
+    size_t mapped = 0;
+    for (int hi = 0xA1; hi <= 0xF7; hi++) {
+        for (int lo = 0xA1; lo <= 0xFE; lo++) {
+            char in[2] = {static_cast<char>(hi), static_cast<char>(lo)};
+            unsigned char out[8];
+            char *inPtr = in;
+            char *outPtr = reinterpret_cast<char*>(out);
+            size_t inLeft = sizeof(in);
+            size_t outLeft = sizeof(out);
+            iconv(cd, nullptr, nullptr, nullptr, nullptr);
+            if (iconv(cd, &inPtr, &inLeft, &outPtr, &outLeft) == static_cast<size_t>(-1) ||
+                sizeof(out) - outLeft != 4) {
+                continue; // 空位
+            }
+            uint32_t cp = out[0] | (out[1] << 8) | (out[2] << 16) | (static_cast<uint32_t>(out[3]) << 24);
+            if (cp < table.size() && table[cp] == 0) {
+                table[cp] = static_cast<uint16_t>((hi << 8) | lo);
+                mapped++;
+            }
+        }
+    }
+    iconv_close(cd);
+    return mapped > 0;
+}
+#endif
+
+// 进程内只初始化一次，之后只读，可多线程并发使用
+struct Collator {
+    Mode mode;
+    std::vector<uint16_t> gb2312;
+    std::locale zhLocale;
+    const std::collate<char> *collate;
+
+    Collator() : mode(Mode::Bytes), collate(nullptr) {
+#ifdef ELECTION_HAVE_ICONV
+        if (buildGb2312Table(gb2312)) {
+            mode = Mode::Pinyin;
+            return;
+        }
+#endif
+        try {
+            zhLocale = std::locale("zh_CN.UTF-8");
+            collate = &std::use_facet<std::collate<char>>(zhLocale);
+            mode = Mode::Locale;
+        } catch (...) {
+            mode = Mode::Bytes;
+        }
+    }
+};
+
+const Collator& collator() {
+    static const Collator instance;
+    return instance;
+}
+
+bool isAsciiEnglishName(const std::string &name) {
+    if (name.empty()) return false;
+    for (unsigned char c : name) {
+        if (c >= 0x80) return false;
+        if (!(std::isalpha(c) || c == ' ')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendUnmapped(uint32_t cp, std::string &key) {
+    key.push_back(static_cast<char>(kUnmappedPrefix));
+    key.push_back(static_cast<char>((cp >> 16) & 0xFF));
+    key.push_back(static_cast<char>((cp >> 8) & 0xFF));
+    key.push_back(static_cast<char>(cp & 0xFF));
+}
+
+// 逐字符映射：ASCII 保持单字节，GB2312 字符为两字节区位码（首字节 >= 0xA1），其余为4字节
+void appendPinyinKey(const std::string &name, const std::vector<uint16_t> &table, std::string &key) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(name.data());
+    const unsigned char *end = p + name.size();
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            key.push_back(static_cast<char>(c));
+            p++;
+            continue;
+        }
+        size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+        if (len == 0 || static_cast<size_t>(end - p) < len) {
+            appendUnmapped(0xFFFF00u | c, key); // 非法字节
+            p++;
+            continue;
+        }
+        uint32_t cp = c & (0x7F >> len);
+        for (size_t k = 1; k < len; k++) {
+            cp = (cp << 6) | (p[k] & 0x3F);
+        }
+        p += len;
+        uint16_t code = cp < table.size() ? table[cp] : 0;
+        if (code != 0) {
+            key.push_back(static_cast<char>(code >> 8));
+            key.push_back(static_cast<char>(code & 0xFF));
+        } else {
+            appendUnmapped(cp, key);
+        }
+    }
+}
+
+// 排序时的内部记录：缓存键的前8个字节（大端），前8层分桶不必访问堆上的字符串
+struct SortItem {
+    uint64_t prefix;
+    const std::string *key;
+    size_t length;
+    int id;
+    size_t index;
+};
+
+const size_t kPrefixBytes = 8;
+
+// depth 处的“字符”：0 表示键已结束，否则为字节值 + 1
+inline unsigned bucketAt(const SortItem &item, size_t depth) {
+    if (depth >= item.length) return 0u;
+    if (depth < kPrefixBytes) {
+        return static_cast<unsigned>((item.prefix >> (8 * (kPrefixBytes - 1 - depth))) & 0xFF) + 1u;
+    }
+    return static_cast<unsigned char>((*item.key)[depth]) + 1u;
+}
+
+struct SuffixLess {
+    size_t depth;
+    bool operator()(const SortItem &a, const SortItem &b) const {
+        if (depth < kPrefixBytes) {
+            // 前缀中 depth 之前的字节已相同，直接比较整个前缀
+            if (a.prefix != b.prefix) return a.prefix < b.prefix;
+        }
+        size_t from = std::max(depth, std::min(kPrefixBytes, std::min(a.length, b.length)));
+        size_t la = a.length - std::min(from, a.length);
+        size_t lb = b.length - std::min(from, b.length);
+        int cmp = std::memcmp(a.key->data() + std::min(from, a.length),
+                              b.key->data() + std::min(from, b.length),
+                              std::min(la, lb));
+        if (cmp != 0) return cmp < 0;
+        if (la != lb) return la < lb;
+        return a.id < b.id;
+    }
+};
+
+void msdSort(SortItem *items, SortItem *scratch, size_t n, size_t depth) {
+    if (n < kRadixCutoff) {
+        SuffixLess less = {depth};
+        std::sort(items, items + n, less);
+        return;
+    }
+
+    size_t counts[257] = {0};
+    for (size_t i = 0; i < n; i++) {
+        counts[bucketAt(items[i], depth)]++;
+    }
+    size_t offsets[257];
+    size_t sum = 0;
+    for (size_t b = 0; b < 257; b++) {
+        offsets[b] = sum;
+        sum += counts[b];
+    }
+    unsigned first = bucketAt(items[0], depth);
+    if (first != 0 && counts[first] == n) {
+        // 全部落在同一个桶：不必搬移，直接处理下一层
+        msdSort(items, scratch, n, depth + 1);
+        return;
+    }
+    size_t next[257];
+    std::copy(offsets, offsets + 257, next);
+    for (size_t i = 0; i < n; i++) {
+        scratch[next[bucketAt(items[i], depth)]++] = items[i];
+    }
+    std::copy(scratch, scratch + n, items);
+
+    // 分桶是稳定的，输入已按 id 有序，桶0（键已结束且相等）无需再排
+    for (size_t b = 1; b < 257; b++) {
+        if (counts[b] > 1) {
+            msdSort(items + offsets[b], scratch + offsets[b], counts[b], depth + 1);
+        }
+    }
+}
+
+// 按 id 做 LSD 基数排序（两趟16位）；已有序时直接返回
+void sortById(std::vector<SortItem> &items, std::vector<SortItem> &scratch) {
+    bool sorted = true;
+    for (size_t i = 1; i < items.size() && sorted; i++) {
+        sorted = items[i - 1].id <= items[i].id;
+    }
+    if (sorted) {
+        return;
+    }
+    for (int shift = 0; shift < 32; shift += 16) {
+        std::vector<size_t> offsets(1u << 16, 0);
+        for (const auto &item : items) {
+            offsets[((static_cast<uint32_t>(item.id) ^ 0x80000000u) >> shift) & 0xFFFF]++;
+        }
+        size_t sum = 0;
+        for (auto &o : offsets) {
+            size_t c = o;
+            o = sum;
+            sum += c;
+        }
+        for (const auto &item : items) {
+            scratch[offsets[((static_cast<uint32_t>(item.id) ^ 0x80000000u) >> shift) & 0xFFFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+} // namespace
+
+std::string NameCollation::sortKey(const std::string &name) {
+    std::string key;
+    key.reserve(name.size() + 1);
+    if (isAsciiEnglishName(name)) {
+        key.push_back(kGroupEnglish);
+        for (unsigned char c : name) {
+            if (c == ' ') continue;
+            key.push_back(static_cast<char>(std::tolower(c)));
+        }
+        return key;
+    }
+
+    key.push_back(kGroupOther);
+    const Collator &coll = collator();
+    switch (coll.mode) {
+    case Mode::Pinyin:
+        appendPinyinKey(name, coll.gb2312, key);
+        break;
+    case Mode::Locale:
+        key += coll.collate->transform(name.data(), name.data() + name.size());
+        break;
+    case Mode::Bytes:
+        key += name;
+        break;
+    }
+    return key;
+}
+
+void NameCollation::radixSort(std::vector<KeyRef> &items) {
+    if (items.size() < 2) {
+        return;
+    }
+    std::vector<SortItem> sortItems(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        const std::string &key = *items[i].key;
+        uint64_t prefix = 0;
+        for (size_t k = 0; k < kPrefixBytes; k++) {
+            prefix = (prefix << 8) | (k < key.size() ? static_cast<unsigned char>(key[k]) : 0u);
+        }
+        SortItem item = {prefix, &key, key.size(), items[i].id, items[i].index};
+        sortItems[i] = item;
+    }
+    std::vector<SortItem> scratch(items.size());
+    sortById(sortItems, scratch);
+    msdSort(sortItems.data(), scratch.data(), sortItems.size(), 0);
+    for (size_t i = 0; i < items.size(); i++) {
+        KeyRef ref = {sortItems[i].key, sortItems[i].id, sortItems[i].index};
+        items[i] = ref;
+    }
+}
+
+const char* NameCollation::activeMode() {
+    switch (collator().mode) {
+    case Mode::Pinyin: return "pinyin";
+    case Mode::Locale: return "locale";
+    case Mode::Bytes:  return "bytes";
+    }
+    return "bytes";
+}
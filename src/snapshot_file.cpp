@@ -0,0 +1,176 @@
+#include "../include/snapshot_file.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ==================== 二进制快照文件实现 ====================
+
+namespace {
+
+const char kMagic[8] = {'E', 'V', 'S', 'N', 'A', 'P', '0', '1'};
+const size_t kBufferSize = 1u << 20;   // 8的倍数：缓冲区满时写出的数据总是整字
+
+bool syncFile(FILE *f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+} // namespace
+
+// ---------- SnapshotFormat ----------
+
+uint64_t SnapshotFormat::checksum(uint64_t h, const char *data, size_t size) {
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h ^= w * 0x9E3779B97F4A7C15ULL;
+        h = rotl64(h, 27) * 0xC2B2AE3D27D4EB4FULL + 0x165667B19E3779F9ULL;
+    }
+    return h;
+}
+
+bool SnapshotFormat::check(const char *data, size_t size, bool verifyChecksum) {
+    if (size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.byteOrder != kByteOrderMark || header.fileSize != size ||
+        (size - sizeof(SnapshotHeader)) % 8 != 0) {
+        return false;
+    }
+    if (!verifyChecksum) {
+        return true;
+    }
+    return checksum(kChecksumSeed, data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) == header.checksum;
+}
+
+bool SnapshotFormat::checkFile(const std::string &path, SnapshotHeader *out) {
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    SnapshotHeader header;
+    bool ok = std::fread(&header, 1, sizeof(header), f) == sizeof(header) &&
+              std::fseek(f, 0, SEEK_END) == 0;
+    long size = ok ? std::ftell(f) : -1;
+    std::fclose(f);
+    if (!ok || size < 0) {
+        return false;
+    }
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.byteOrder != kByteOrderMark || header.fileSize != static_cast<uint64_t>(size)) {
+        return false;
+    }
+    if (out) {
+        *out = header;
+    }
+    return true;
+}
+
+// ---------- SnapshotWriter ----------
+
+SnapshotWriter::SnapshotWriter()
+    : file(nullptr), used(0), offset(0), checksum(SnapshotFormat::kChecksumSeed), ok(false) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (file) {
+        std::fclose(file);
+        std::remove(tempPath.c_str());
+    }
+}
+
+bool SnapshotWriter::open(const std::string &path) {
+    target = path;
+    tempPath = path + ".tmp";
+    file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        ok = false;
+        return false;
+    }
+    // 先占位文件头，commit 时回填
+    SnapshotHeader blank;
+    std::memset(&blank, 0, sizeof(blank));
+    ok = std::fwrite(&blank, 1, sizeof(blank), file) == sizeof(blank);
+    buffer.resize(kBufferSize);
+    used = 0;
+    offset = 0;
+    checksum = SnapshotFormat::kChecksumSeed;
+    return ok;
+}
+
+void SnapshotWriter::write(const void *data, size_t size) {
+    const char *src = static_cast<const char*>(data);
+    while (size > 0 && ok) {
+        size_t n = std::min(size, buffer.size() - used);
+        std::memcpy(buffer.data() + used, src, n);
+        used += n;
+        offset += n;
+        src += n;
+        size -= n;
+        if (used == buffer.size()) {
+            flushBuffer();
+        }
+    }
+}
+
+void SnapshotWriter::align() {
+    static const char zeros[8] = {0};
+    size_t pad = static_cast<size_t>((8 - offset % 8) % 8);
+    if (pad > 0) {
+        write(zeros, pad);
+    }
+}
+
+void SnapshotWriter::flushBuffer() {
+    if (used == 0 || !ok) {
+        return;
+    }
+    checksum = SnapshotFormat::checksum(checksum, buffer.data(), used);
+    ok = std::fwrite(buffer.data(), 1, used, file) == used;
+    used = 0;
+}
+
+bool SnapshotWriter::commit(SnapshotHeader header) {
+    if (!file) {
+        return false;
+    }
+    align();
+    flushBuffer();
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = SnapshotFormat::kVersion;
+    header.byteOrder = SnapshotFormat::kByteOrderMark;
+    header.fileSize = sizeof(SnapshotHeader) + offset;
+    header.checksum = checksum;
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 &&
+         std::fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+         std::fflush(file) == 0 && syncFile(file);
+    ok = (std::fclose(file) == 0) && ok;
+    file = nullptr;
+    if (!ok) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    std::remove(target.c_str());    // Windows 上 rename 不覆盖已有文件
+#endif
+    if (std::rename(tempPath.c_str(), target.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        ok = false;
+    }
+    return ok;
+}
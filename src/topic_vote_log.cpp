@@ -0,0 +1,341 @@
+#include "../include/topic_vote_log.h"
+#include "../include/snapshot_file.h"
+
+#include <limits>
+
+// ==================== 列式话题投票历史实现 ====================
+
+namespace {
+
+inline uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t unzigzag(uint32_t v) {
+    return static_cast<int32_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+inline void putVarint(std::string &out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// 不读过 end，32位值最多5字节；数据截断或过长时返回 false
+inline bool getVarint(const unsigned char *&p, const unsigned char *end, uint32_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        unsigned char b = *p++;
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 一列按与前一个值的差值编码（差值以32位回绕计算，解码时同样回绕，结果精确）
+template <class T>
+void packColumn(const std::vector<T> &column, std::string &out) {
+    uint32_t prev = 0;
+    for (T value : column) {
+        uint32_t cur = static_cast<uint32_t>(value);
+        putVarint(out, zigzag(static_cast<int32_t>(cur - prev)));
+        prev = cur;
+    }
+}
+
+template <class T>
+bool unpackColumn(const unsigned char *&p, const unsigned char *end, size_t n, std::vector<T> &column) {
+    column.resize(n);
+    uint32_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t delta = 0;
+        if (!getVarint(p, end, delta)) {
+            return false;
+        }
+        prev += static_cast<uint32_t>(unzigzag(delta));
+        column[i] = static_cast<T>(prev);
+    }
+    return true;
+}
+
+// 句柄列中不能有超出投票人字典的句柄
+bool votersInRange(const std::vector<uint32_t> &voters, size_t voterCount) {
+    for (uint32_t v : voters) {
+        if (v >= voterCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void TopicVoteLog::Columns::clear() {
+    voters.clear();
+    options.clear();
+    timeOffsets.clear();
+    seqOffsets.clear();
+}
+
+void TopicVoteLog::Columns::reserve(size_t n) {
+    voters.reserve(n);
+    options.reserve(n);
+    timeOffsets.reserve(n);
+    seqOffsets.reserve(n);
+}
+
+void TopicVoteLog::Columns::release() {
+    std::vector<uint32_t>().swap(voters);
+    std::vector<int32_t>().swap(options);
+    std::vector<int32_t>().swap(timeOffsets);
+    std::vector<uint32_t>().swap(seqOffsets);
+}
+
+void TopicVoteLog::Columns::popBack() {
+    voters.pop_back();
+    options.pop_back();
+    timeOffsets.pop_back();
+    seqOffsets.pop_back();
+}
+
+size_t TopicVoteLog::Columns::capacityBytes() const {
+    return voters.capacity() * sizeof(uint32_t) + options.capacity() * sizeof(int32_t) +
+           timeOffsets.capacity() * sizeof(int32_t) + seqOffsets.capacity() * sizeof(uint32_t);
+}
+
+TopicVoteLog::TopicVoteLog(int topic)
+    : topicId(topic), count(0), compress(false), undoWindow(kDefaultUndoWindow), firstUncompressed(0), coldCount(0) {}
+
+void TopicVoteLog::append(const TopicVoteEntry &entry) {
+    int64_t t = static_cast<int64_t>(entry.votedAt);
+    bool newBlock = blocks.empty() || blocks.back().size() >= kBlockSize || !blocks.back().packed.empty();
+    if (!newBlock) {
+        // 时间偏移超出32位（相差约68年）或序号差超出32位时另起一块
+        int64_t offset = t - blocks.back().baseTime;
+        newBlock = offset < std::numeric_limits<int32_t>::min() || offset > std::numeric_limits<int32_t>::max() ||
+                   entry.sequence - blocks.back().baseSequence > std::numeric_limits<uint32_t>::max();
+    }
+    if (newBlock) {
+        blocks.push_back(Block());
+        blocks.back().baseTime = t;
+        blocks.back().baseSequence = entry.sequence;
+        blocks.back().columns.reserve(kBlockSize);
+    }
+    Block &block = blocks.back();
+    block.columns.voters.push_back(entry.voter);
+    block.columns.options.push_back(entry.optionId);
+    block.columns.timeOffsets.push_back(static_cast<int32_t>(t - block.baseTime));
+    block.columns.seqOffsets.push_back(static_cast<uint32_t>(entry.sequence - block.baseSequence));
+    count++;
+    if (newBlock && compress) {
+        compressColdBlocks();
+    }
+}
+
+TopicVoteEntry TopicVoteLog::back() const {
+    const Block &block = blocks.back();
+    if (!block.packed.empty()) {
+        Columns cols;
+        unpack(block, cols);
+        return entryAt(block, cols, cols.size() - 1);
+    }
+    return entryAt(block, block.columns, block.columns.size() - 1);
+}
+
+void TopicVoteLog::popBack() {
+    size_t last = blocks.size() - 1;
+    Block &block = blocks[last];
+    if (firstUncompressed > last) {
+        // 撤销超出了撤销窗口：解压该块
+        coldCount -= block.size();
+        firstUncompressed = last;
+        if (!block.packed.empty()) {
+            unpack(block, block.columns);
+            std::string().swap(block.packed);
+            block.packedCount = 0;
+        }
+    }
+    block.columns.popBack();
+    count--;
+    if (block.columns.size() == 0) {
+        blocks.pop_back();
+    }
+}
+
+void TopicVoteLog::clear() {
+    blocks.clear();
+    count = 0;
+    firstUncompressed = 0;
+    coldCount = 0;
+}
+
+void TopicVoteLog::reserve(size_t n) {
+    blocks.reserve((count + n) / kBlockSize + 1);
+}
+
+void TopicVoteLog::setCompression(bool enabled, size_t window) {
+    compress = enabled;
+    undoWindow = window;
+    if (compress) {
+        compressColdBlocks();
+    }
+}
+
+size_t TopicVoteLog::memoryBytes() const {
+    size_t bytes = blocks.capacity() * sizeof(Block);
+    for (const auto &block : blocks) {
+        bytes += block.columns.capacityBytes() + block.packed.capacity();
+    }
+    return bytes;
+}
+
+// 从第一个未压缩块起，压缩其后记录数不少于撤销窗口的块（最后一块始终不压缩），摊还 O(1)
+void TopicVoteLog::compressColdBlocks() {
+    size_t after = count - coldCount;
+    while (firstUncompressed + 1 < blocks.size()) {
+        Block &block = blocks[firstUncompressed];
+        size_t n = block.size();
+        if (after - n < undoWindow) {
+            break;
+        }
+        if (block.packed.empty()) {
+            pack(block);
+        }
+        after -= n;
+        coldCount += n;
+        firstUncompressed++;
+    }
+}
+
+void TopicVoteLog::pack(Block &block) {
+    const Columns &cols = block.columns;
+    std::string out;
+    out.reserve(cols.size() * 4);
+    packColumn(cols.voters, out);
+    packColumn(cols.options, out);
+    packColumn(cols.timeOffsets, out);
+    packColumn(cols.seqOffsets, out);
+    out.shrink_to_fit();
+    block.packedCount = static_cast<uint32_t>(cols.size());
+    block.packed.swap(out);
+    block.columns.release();
+}
+
+bool TopicVoteLog::unpack(const Block &block, Columns &out) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(block.packed.data());
+    const unsigned char *end = p + block.packed.size();
+    size_t n = block.packedCount;
+    return unpackColumn(p, end, n, out.voters) && unpackColumn(p, end, n, out.options) &&
+           unpackColumn(p, end, n, out.timeOffsets) && unpackColumn(p, end, n, out.seqOffsets) && p == end;
+}
+
+TopicVoteLog::Cursor::Cursor(const TopicVoteLog &source) : log(&source), block(0), index(0) {
+    enterBlock();
+}
+
+void TopicVoteLog::Cursor::next() {
+    if (++index == columns().size()) {
+        block++;
+        index = 0;
+        enterBlock();
+    }
+}
+
+void TopicVoteLog::Cursor::enterBlock() {
+    if (valid() && !log->blocks[block].packed.empty()) {
+        unpack(log->blocks[block], scratch);
+    }
+}
+
+void TopicVoteLog::saveSnapshot(SnapshotWriter &out) const {
+    out.writeValue<uint64_t>(count);
+    out.writeValue<uint64_t>(firstUncompressed);
+    out.writeValue<uint64_t>(coldCount);
+    out.writeValue<uint64_t>(blocks.size());
+    for (const auto &block : blocks) {
+        out.writeValue<int64_t>(block.baseTime);
+        out.writeValue<uint64_t>(block.baseSequence);
+        out.writeValue<uint32_t>(static_cast<uint32_t>(block.size()));
+        out.writeValue<uint32_t>(block.packed.empty() ? 0 : 1);
+        if (!block.packed.empty()) {
+            out.writeArray(block.packed.data(), block.packed.size());
+        } else {
+            out.writeArray(block.columns.voters);
+            out.writeArray(block.columns.options);
+            out.writeArray(block.columns.timeOffsets);
+            out.writeArray(block.columns.seqOffsets);
+        }
+    }
+}
+
+bool TopicVoteLog::loadSnapshot(SnapshotReader &in, size_t voterCount) {
+    clear();
+    uint64_t savedCount = 0;
+    uint64_t savedFirst = 0;
+    uint64_t savedCold = 0;
+    uint64_t blockCount = 0;
+    in.readValue(savedCount);
+    in.readValue(savedFirst);
+    in.readValue(savedCold);
+    in.readValue(blockCount);
+    if (!in.good() || blockCount > savedCount || savedFirst > blockCount) {
+        return false;
+    }
+
+    // 不依赖校验和：压缩块必须能在自身范围内完整解码、只出现在撤销窗口之外（popBack 的前提），
+    // 句柄不超出投票人字典
+    blocks.resize(static_cast<size_t>(blockCount));
+    size_t total = 0;
+    size_t cold = 0;
+    Columns scratch;
+    for (size_t b = 0; b < blocks.size(); b++) {
+        Block &block = blocks[b];
+        uint32_t n = 0;
+        uint32_t packed = 0;
+        in.readValue(block.baseTime);
+        in.readValue(block.baseSequence);
+        in.readValue(n);
+        in.readValue(packed);
+        bool ok = in.good() && n > 0 && n <= kBlockSize;
+        if (ok && packed) {
+            uint64_t size = 0;
+            const char *data = in.readArray<char>(size);
+            ok = data != nullptr && size > 0 && b < savedFirst;
+            if (ok) {
+                block.packed.assign(data, static_cast<size_t>(size));
+                block.packedCount = n;
+                ok = unpack(block, scratch) && votersInRange(scratch.voters, voterCount);
+            }
+        } else if (ok) {
+            Columns &cols = block.columns;
+            ok = in.readArray(cols.voters) && in.readArray(cols.options) &&
+                 in.readArray(cols.timeOffsets) && in.readArray(cols.seqOffsets) &&
+                 cols.voters.size() == n && cols.options.size() == n &&
+                 cols.timeOffsets.size() == n && cols.seqOffsets.size() == n &&
+                 votersInRange(cols.voters, voterCount);
+        }
+        if (!ok) {
+            clear();
+            return false;
+        }
+        total += n;
+        if (b < savedFirst) {
+            cold += n;
+        }
+    }
+    if (total != savedCount || cold != savedCold) {
+        clear();
+        return false;
+    }
+    count = total;
+    firstUncompressed = static_cast<size_t>(savedFirst);
+    coldCount = cold;
+    if (compress) {
+        compressColdBlocks();
+    }
+    return true;
+}
@@ -0,0 +1,194 @@
+#include "../include/vote_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ELECTION_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+// ==================== 选票直方图内核实现 ====================
+
+namespace {
+
+// 子直方图数量：相邻选票轮流写入不同子直方图，打断对热门候选人的连续写依赖
+const size_t kLanes = 4;
+// 计数范围超过该值时多份子直方图会挤出缓存，改用单份
+const size_t kMaxMultiLaneRange = 1u << 16;
+// 每块最多处理的选票数，保证 uint32 子计数不会溢出
+const size_t kBlockSize = 1u << 28;
+
+std::atomic<int> g_preferredKernel(static_cast<int>(VoteHistogram::Kernel::Auto));
+
+struct Lanes {
+    uint32_t *h0;
+    uint32_t *h1;
+    uint32_t *h2;
+    uint32_t *h3;
+};
+
+inline void bumpOrReject(uint32_t offset, uint32_t range, uint32_t *hist, size_t pos,
+                         size_t &rejected, std::vector<size_t> *positions) {
+    if (offset < range) {
+        hist[offset]++;
+    } else {
+        rejected++;
+        if (positions) positions->push_back(pos);
+    }
+}
+
+size_t countScalar(const int *votes, size_t n, size_t posBase, int base, uint32_t range,
+                   const Lanes &lanes, std::vector<size_t> *positions) {
+    const uint32_t ubase = static_cast<uint32_t>(base);
+    size_t rejected = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32_t o0 = static_cast<uint32_t>(votes[i]) - ubase;
+        uint32_t o1 = static_cast<uint32_t>(votes[i + 1]) - ubase;
+        uint32_t o2 = static_cast<uint32_t>(votes[i + 2]) - ubase;
+        uint32_t o3 = static_cast<uint32_t>(votes[i + 3]) - ubase;
+        if (o0 < range && o1 < range && o2 < range && o3 < range) {
+            lanes.h0[o0]++;
+            lanes.h1[o1]++;
+            lanes.h2[o2]++;
+            lanes.h3[o3]++;
+        } else {
+            bumpOrReject(o0, range, lanes.h0, posBase + i, rejected, positions);
+            bumpOrReject(o1, range, lanes.h1, posBase + i + 1, rejected, positions);
+            bumpOrReject(o2, range, lanes.h2, posBase + i + 2, rejected, positions);
+            bumpOrReject(o3, range, lanes.h3, posBase + i + 3, rejected, positions);
+        }
+    }
+    for (; i < n; i++) {
+        bumpOrReject(static_cast<uint32_t>(votes[i]) - ubase, range, lanes.h0, posBase + i, rejected, positions);
+    }
+    return rejected;
+}
+
+#ifdef ELECTION_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+size_t countAvx2(const int *votes, size_t n, size_t posBase, int base, uint32_t range,
+                 const Lanes &lanes, std::vector<size_t> *positions) {
+    const __m256i vbase = _mm256_set1_epi32(base);
+    const __m256i vlimit = _mm256_set1_epi32(static_cast<int>(range - 1));
+    alignas(32) uint32_t off[8];
+
+    size_t rejected = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(votes + i));
+        __m256i o = _mm256_sub_epi32(v, vbase);
+        // 无符号比较 o <= range - 1：max(o, limit) == limit
+        __m256i inRange = _mm256_cmpeq_epi32(_mm256_max_epu32(o, vlimit), vlimit);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(inRange));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(off), o);
+
+        if (mask == 0xFF) {
+            lanes.h0[off[0]]++;
+            lanes.h1[off[1]]++;
+            lanes.h2[off[2]]++;
+            lanes.h3[off[3]]++;
+            lanes.h0[off[4]]++;
+            lanes.h1[off[5]]++;
+            lanes.h2[off[6]]++;
+            lanes.h3[off[7]]++;
+        } else {
+            for (int k = 0; k < 8; k++) {
+                if (mask & (1 << k)) {
+                    lanes.h0[off[k]]++;
+                } else {
+                    rejected++;
+                    if (positions) positions->push_back(posBase + i + k);
+                }
+            }
+        }
+    }
+    if (i < n) {
+        rejected += countScalar(votes + i, n - i, posBase + i, base, range, lanes, positions);
+    }
+    return rejected;
+}
+
+bool detectAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}
+
+#endif // ELECTION_HAVE_AVX2_KERNEL
+
+bool useAvx2() {
+#ifdef ELECTION_HAVE_AVX2_KERNEL
+    static const bool supported = detectAvx2();
+    return supported && g_preferredKernel.load(std::memory_order_relaxed) != static_cast<int>(VoteHistogram::Kernel::Scalar);
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+size_t VoteHistogram::count(const int *votes, size_t n, int base, size_t range,
+                            uint64_t *counts, std::vector<size_t> *outOfRangePositions) {
+    if (range == 0 || range > 0xFFFFFFFFu) {
+        if (outOfRangePositions) {
+            for (size_t i = 0; i < n; i++) outOfRangePositions->push_back(i);
+        }
+        return n;
+    }
+
+    const uint32_t range32 = static_cast<uint32_t>(range);
+    const size_t laneCount = range <= kMaxMultiLaneRange ? kLanes : 1;
+    std::vector<uint32_t> sub(laneCount * range);
+    Lanes lanes;
+    lanes.h0 = sub.data();
+    lanes.h1 = laneCount > 1 ? sub.data() + range : lanes.h0;
+    lanes.h2 = laneCount > 1 ? sub.data() + 2 * range : lanes.h0;
+    lanes.h3 = laneCount > 1 ? sub.data() + 3 * range : lanes.h0;
+
+    const bool avx2 = useAvx2();
+    size_t rejected = 0;
+    for (size_t start = 0; start < n; start += kBlockSize) {
+        size_t len = std::min(kBlockSize, n - start);
+#ifdef ELECTION_HAVE_AVX2_KERNEL
+        if (avx2) {
+            rejected += countAvx2(votes + start, len, start, base, range32, lanes, outOfRangePositions);
+        } else
+#endif
+        {
+            rejected += countScalar(votes + start, len, start, base, range32, lanes, outOfRangePositions);
+        }
+
+        // 合并子直方图
+        for (size_t k = 0; k < range; k++) {
+            uint64_t total = lanes.h0[k];
+            if (laneCount > 1) {
+                total += static_cast<uint64_t>(lanes.h1[k]) + lanes.h2[k] + lanes.h3[k];
+            }
+            counts[k] += total;
+        }
+        if (start + len < n) {
+            std::fill(sub.begin(), sub.end(), 0u);
+        }
+    }
+    (void)avx2;
+    return rejected;
+}
+
+void VoteHistogram::setKernel(Kernel kernel) {
+    g_preferredKernel.store(static_cast<int>(kernel), std::memory_order_relaxed);
+}
+
+bool VoteHistogram::avx2Available() {
+#ifdef ELECTION_HAVE_AVX2_KERNEL
+    static const bool supported = detectAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+const char* VoteHistogram::activeKernelName() {
+    return useAvx2() ? "avx2" : "scalar";
+}
@@ -0,0 +1,312 @@
+#include "../include/vote_journal.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ==================== 话题投票预写日志实现 ====================
+
+namespace {
+
+const char kMagic[4] = {'E', 'V', 'J', 'L'};
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 8;
+const size_t kFrameOverhead = 9;                  // 负载长度 + 事件 + CRC32
+const uint32_t kMaxPayload = 64u << 20;           // 超过该长度的记录视为损坏
+const size_t kMaxPendingBytes = 64u << 20;        // 待写数据超过该值时追加方等待写线程
+
+// CRC32（IEEE 802.3，反射多项式 0xEDB88320）
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+const Crc32Table kCrcTable;
+
+uint32_t crc32Update(uint32_t crc, const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc = kCrcTable.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+uint32_t recordCrc(uint8_t event, const char *payload, size_t size) {
+    char e = static_cast<char>(event);
+    uint32_t crc = crc32Update(0xFFFFFFFFu, &e, 1);
+    return crc32Update(crc, payload, size) ^ 0xFFFFFFFFu;
+}
+
+void appendU32(std::string &out, uint32_t v) {
+    char b[4];
+    for (int i = 0; i < 4; i++) b[i] = static_cast<char>(v >> (8 * i));
+    out.append(b, 4);
+}
+
+uint32_t readU32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+bool syncFile(FILE *f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+bool truncateFile(FILE *f, uint64_t length) {
+#ifdef _WIN32
+    return _chsize_s(_fileno(f), static_cast<long long>(length)) == 0;
+#else
+    return ftruncate(fileno(f), static_cast<off_t>(length)) == 0;
+#endif
+}
+
+} // namespace
+
+VoteJournal::VoteJournal()
+    : file(nullptr), pendingRecords(0), appendedCount(0), committedCount(0),
+      committedBytes(0), flushRequested(false), stopping(false), error(false) {}
+
+VoteJournal::~VoteJournal() {
+    close();
+}
+
+bool VoteJournal::open(const std::string &path, uint64_t validLength, const Options &options) {
+    close();
+    FILE *f = nullptr;
+    if (validLength < kHeaderSize) {
+        f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            return false;
+        }
+        std::string header(kMagic, sizeof(kMagic));
+        appendU32(header, kVersion);
+        if (std::fwrite(header.data(), 1, header.size(), f) != header.size() || std::fflush(f) != 0) {
+            std::fclose(f);
+            return false;
+        }
+    } else {
+        // 丢弃崩溃时写了一半的尾部记录，从有效数据末尾继续追加
+        f = std::fopen(path.c_str(), "r+b");
+        if (!f) {
+            return false;
+        }
+        if (!truncateFile(f, validLength) || std::fseek(f, 0, SEEK_END) != 0) {
+            std::fclose(f);
+            return false;
+        }
+    }
+
+    file = f;
+    opts = options;
+    if (opts.flushRecords == 0) {
+        opts.flushRecords = 1;
+    }
+    pending.clear();
+    pendingRecords = 0;
+    appendedCount = 0;
+    committedCount = 0;
+    committedBytes = validLength < kHeaderSize ? kHeaderSize : validLength;
+    flushRequested = false;
+    stopping = false;
+    error = false;
+    writer = std::thread(&VoteJournal::writerLoop, this);
+    return true;
+}
+
+void VoteJournal::close() {
+    if (!file) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void VoteJournal::append(const JournalEncoder &record) {
+    const std::string &payload = record.bytes();
+    uint8_t event = static_cast<uint8_t>(record.type());
+    uint32_t crc = recordCrc(event, payload.data(), payload.size());
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (error) {
+        return;
+    }
+    if (pending.size() >= kMaxPendingBytes) {
+        // 写线程跟不上时限制缓冲区大小
+        flushRequested = true;
+        wake.notify_one();
+        uint64_t target = appendedCount;
+        committed.wait(lock, [&]() { return committedCount >= target || error; });
+        if (error) {
+            return;
+        }
+    }
+    appendU32(pending, static_cast<uint32_t>(payload.size()));
+    pending.push_back(static_cast<char>(event));
+    pending.append(payload);
+    appendU32(pending, crc);
+    appendedCount++;
+    if (++pendingRecords == opts.flushRecords) {
+        wake.notify_one();
+    }
+}
+
+bool VoteJournal::sync() {
+    if (!file) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appendedCount;
+    if (committedCount < target) {
+        flushRequested = true;
+        wake.notify_one();
+        committed.wait(lock, [&]() { return committedCount >= target || error; });
+    }
+    return !error;
+}
+
+bool VoteJournal::failed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+uint64_t VoteJournal::length() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return committedBytes;
+}
+
+// 组提交：等待提交间隔、记录数阈值或显式 sync，然后把整批记录一次写入并落盘
+void VoteJournal::writerLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait_for(lock, std::chrono::milliseconds(opts.flushIntervalMs), [&]() {
+            return stopping || flushRequested || pendingRecords >= opts.flushRecords;
+        });
+        if (pending.empty()) {
+            flushRequested = false;
+            if (stopping) {
+                break;
+            }
+            continue;
+        }
+        batch.swap(pending);
+        pendingRecords = 0;
+        flushRequested = false;
+        uint64_t target = appendedCount;
+        uint64_t batchBytes = batch.size();
+
+        lock.unlock();
+        bool ok = writeBatch(batch);
+        batch.clear();
+        lock.lock();
+
+        if (ok) {
+            committedBytes += batchBytes;
+        } else {
+            error = true;
+            pending.clear();
+            pendingRecords = 0;
+        }
+        committedCount = target;
+        committed.notify_all();
+        if (stopping && pending.empty()) {
+            break;
+        }
+    }
+}
+
+bool VoteJournal::writeBatch(const std::string &batch) {
+    if (std::fwrite(batch.data(), 1, batch.size(), file) != batch.size()) {
+        return false;
+    }
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+    return !opts.syncToDisk || syncFile(file);
+}
+
+bool VoteJournal::replay(const std::string &path, const std::function<bool(JournalDecoder&)> &fn,
+                         uint64_t *validLength, uint64_t *records, uint64_t *rejected) {
+    *validLength = 0;
+    if (records) *records = 0;
+    if (rejected) *rejected = 0;
+
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return true;    // 尚无日志
+    }
+
+    char header[kHeaderSize];
+    size_t got = std::fread(header, 1, kHeaderSize, f);
+    if (got < kHeaderSize) {
+        // 文件头都没写完：视为空日志
+        std::fclose(f);
+        return true;
+    }
+    if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0 || readU32(header + 4) != kVersion) {
+        std::fclose(f);
+        return false;
+    }
+
+    uint64_t offset = kHeaderSize;
+    uint64_t count = 0;
+    uint64_t skipped = 0;
+    std::vector<char> buffer;
+    char frame[5];
+    for (;;) {
+        if (std::fread(frame, 1, 5, f) != 5) {
+            break;
+        }
+        uint32_t size = readU32(frame);
+        if (size > kMaxPayload) {
+            break;
+        }
+        buffer.resize(size + 4);
+        if (std::fread(buffer.data(), 1, buffer.size(), f) != buffer.size()) {
+            break;
+        }
+        uint8_t event = static_cast<uint8_t>(frame[4]);
+        if (recordCrc(event, buffer.data(), size) != readU32(buffer.data() + size)) {
+            break;
+        }
+        // 帧与校验和完好但内容无法应用的记录（如更新版本写入的事件）跳过，之后的记录照常重放
+        JournalDecoder decoder(static_cast<JournalEvent>(event), buffer.data(), size);
+        if (fn(decoder)) {
+            count++;
+        } else {
+            skipped++;
+        }
+        offset += kFrameOverhead + size;
+    }
+    std::fclose(f);
+
+    *validLength = offset;
+    if (records) *records = count;
+    if (rejected) *rejected = skipped;
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "../include/vote_parser.h"
+
+// ==================== 分块预读实现 ====================
+
+ChunkPrefetcher::ChunkPrefetcher(std::istream &input, size_t chunkBytes)
+    : in(input), current(0), holding(false), finished(false), stopping(false), consumed(0) {
+    if (chunkBytes == 0) {
+        chunkBytes = 1;
+    }
+    for (int i = 0; i < 2; i++) {
+        buffers[i].resize(chunkBytes);
+        filled[i] = 0;
+        full[i] = false;
+    }
+    reader = std::thread(&ChunkPrefetcher::readLoop, this);
+}
+
+ChunkPrefetcher::~ChunkPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    reader.join();
+}
+
+bool ChunkPrefetcher::next(const char *&data, size_t &size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (holding) {
+        // 交还上一块，读线程可继续向其中读入
+        full[current ^ 1] = false;
+        holding = false;
+        changed.notify_all();
+    }
+    changed.wait(lock, [&]() { return full[current] || finished; });
+    if (!full[current]) {
+        return false;
+    }
+    data = buffers[current].data();
+    size = filled[current];
+    consumed += size;
+    holding = true;
+    current ^= 1;
+    return true;
+}
+
+void ChunkPrefetcher::readLoop() {
+    size_t slot = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return !full[slot] || stopping; });
+            if (stopping) {
+                break;
+            }
+        }
+        // 读入时不持锁：该缓冲区此时只属于读线程
+        std::vector<char> &buffer = buffers[slot];
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        size_t got = static_cast<size_t>(in.gcount());
+        bool end = got < buffer.size() || !in;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (got > 0) {
+            filled[slot] = got;
+            full[slot] = true;
+        }
+        if (end) {
+            finished = true;
+        }
+        changed.notify_all();
+        if (end) {
+            break;
+        }
+        slot ^= 1;
+    }
+}
@@ -0,0 +1,158 @@
+#include "../include/voter_dictionary.h"
+#include "../include/snapshot_file.h"
+
+#include <cstring>
+
+// ==================== 投票人ID字典实现 ====================
+
+namespace {
+
+const size_t kMinSlots = 16;
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// 索引容量：保持装载率不超过 1/2
+size_t slotsFor(size_t n) {
+    size_t capacity = kMinSlots;
+    while (capacity < n * 2) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+} // namespace
+
+VoterDictionary::VoterDictionary() : offsets(1, 0) {}
+
+// 按8字节字混合，末尾不足8字节的部分补零后作为一个字，最后用 MurmurHash3 finalizer 扩散
+uint32_t VoterDictionary::hashOf(const char *data, size_t size) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (static_cast<uint64_t>(size) * 0xC2B2AE3D27D4EB4FULL);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = rotl64(h ^ (w * 0x87C37B91114253D5ULL), 31) * 0x4CF5AD432745937FULL;
+    }
+    if (i < size) {
+        uint64_t w = 0;
+        std::memcpy(&w, data + i, size - i);
+        h = rotl64(h ^ (w * 0x87C37B91114253D5ULL), 31) * 0x4CF5AD432745937FULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+
+size_t VoterDictionary::probe(const char *data, size_t size, uint32_t hash) const {
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    for (;;) {
+        uint32_t slot = slots[i];
+        if (slot == 0) {
+            return i;
+        }
+        VoterHandle h = slot - 1;
+        if (hashes[h] == hash && idLength(h) == size && std::memcmp(idData(h), data, size) == 0) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+void VoterDictionary::rehash(size_t capacity) {
+    std::vector<uint32_t> fresh(capacity, 0);
+    size_t mask = capacity - 1;
+    for (VoterHandle h = 0; h < hashes.size(); h++) {
+        size_t i = hashes[h] & mask;
+        while (fresh[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        fresh[i] = h + 1;
+    }
+    slots.swap(fresh);
+}
+
+VoterHandle VoterDictionary::intern(const std::string &voterId) {
+    if ((hashes.size() + 1) * 2 > slots.size()) {
+        rehash(slotsFor(hashes.size() + 1));
+    }
+    uint32_t hash = hashOf(voterId.data(), voterId.size());
+    size_t i = probe(voterId.data(), voterId.size(), hash);
+    if (slots[i] != 0) {
+        return slots[i] - 1;
+    }
+    VoterHandle handle = static_cast<VoterHandle>(hashes.size());
+    text.append(voterId);
+    offsets.push_back(text.size());
+    hashes.push_back(hash);
+    slots[i] = handle + 1;
+    return handle;
+}
+
+VoterHandle VoterDictionary::find(const std::string &voterId) const {
+    if (slots.empty()) {
+        return kNoVoter;
+    }
+    size_t i = probe(voterId.data(), voterId.size(), hashOf(voterId.data(), voterId.size()));
+    return slots[i] == 0 ? kNoVoter : slots[i] - 1;
+}
+
+void VoterDictionary::reserve(size_t n) {
+    offsets.reserve(n + 1);
+    hashes.reserve(n);
+    if (slotsFor(n) > slots.size()) {
+        rehash(slotsFor(n));
+    }
+}
+
+void VoterDictionary::clear() {
+    std::string().swap(text);
+    std::vector<uint64_t>(1, 0).swap(offsets);
+    std::vector<uint32_t>().swap(hashes);
+    std::vector<uint32_t>().swap(slots);
+}
+
+void VoterDictionary::saveSnapshot(SnapshotWriter &out) const {
+    out.writeArray(text.data(), text.size());
+    out.writeArray(offsets);
+    out.writeArray(hashes);
+    out.writeArray(slots);
+}
+
+bool VoterDictionary::loadSnapshot(SnapshotReader &in) {
+    clear();
+    uint64_t textSize = 0, offsetCount = 0, hashCount = 0, slotCount = 0;
+    const char *textData = in.readArray<char>(textSize);
+    const uint64_t *offsetData = in.readArray<uint64_t>(offsetCount);
+    const uint32_t *hashData = in.readArray<uint32_t>(hashCount);
+    const uint32_t *slotData = in.readArray<uint32_t>(slotCount);
+    if (!in.good() || offsetCount != hashCount + 1 || offsetData[0] != 0 || offsetData[hashCount] != textSize ||
+        hashCount >= kNoVoter || (slotCount == 0 ? hashCount != 0 : (slotCount & (slotCount - 1)) != 0 || slotCount < hashCount * 2)) {
+        return false;
+    }
+    // 偏移必须单调，索引中的句柄不越界且非空槽位数等于ID数，保证之后的查找不越界且能终止
+    for (uint64_t i = 0; i < hashCount; i++) {
+        if (offsetData[i] > offsetData[i + 1]) {
+            return false;
+        }
+    }
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < slotCount; i++) {
+        if (slotData[i] > hashCount) {
+            return false;
+        }
+        used += slotData[i] != 0;
+    }
+    if (used != hashCount) {
+        return false;
+    }
+
+    text.assign(textData, static_cast<size_t>(textSize));
+    offsets.assign(offsetData, offsetData + offsetCount);
+    hashes.assign(hashData, hashData + hashCount);
+    slots.assign(slotData, slotData + slotCount);
+    return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * 旧版（未加引号）话题文件的读取回归测试
+ * 标题以引号开头但引号后不是分隔符（"Best" pick）、引号到文件末尾都未闭合（"open）时，
+ * 两种字段都按普通字符读取，不能吞掉后面的记录
+ */
+#include "../include/csv_codec.h"
+#include "../include/election_core.h"
+
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+std::string legacyTopicsFile(int voteCount) {
+    std::ostringstream out;
+    out << "#TOPICS\n"
+        << "topicId,title,description,createdAt,votesPerVoter\n"
+        << "1,\"Best\" pick,d,100,1\n"
+        << "2,\"open,d,100,1\n"
+        << "#OPTIONS\n"
+        << "topicId,optionId,text,voteCount\n"
+        << "1,1,a,0\n"
+        << "1,2,b,0\n"
+        << "2,1,c,0\n"
+        << "2,2,\"d,0\n"
+        << "#VOTES\n"
+        << "topicId,voterId,optionId,votedAt\n";
+    for (int i = 0; i < voteCount; i++) {
+        out << (i % 2 + 1) << ",u" << i << "," << (i % 3 == 0 ? 2 : 1) << ",100\n";
+    }
+    // 投票人ID同样可能是旧版写出的单独引号
+    out << "1,\"x,2,100\n";
+    return out.str();
+}
+
+void testReaderFields() {
+    const std::string data = "\"Best\" pick,1\n\"open,2\n\"ok\",3\n\"tail";
+    CsvReader reader(data.data(), data.size());
+    CsvField fields[4];
+    std::string text;
+
+    check(reader.next(fields, 4) == 2, "\"Best\" pick 记录应为两个字段");
+    CsvCodec::decode(fields[0], text);
+    check(!fields[0].quoted && text == "\"Best\" pick", "\"Best\" pick 应按普通字符读取");
+
+    check(reader.next(fields, 4) == 2, "\"open 记录应为两个字段");
+    CsvCodec::decode(fields[0], text);
+    check(!fields[0].quoted && text == "\"open", "\"open 应按普通字符读取");
+
+    check(reader.next(fields, 4) == 2, "\"ok\" 记录应为两个字段");
+    CsvCodec::decode(fields[0], text);
+    check(fields[0].quoted && text == "ok", "\"ok\" 仍是引号字段");
+
+    check(reader.next(fields, 4) == 1, "末尾未闭合的引号字段应按普通字符读取");
+    CsvCodec::decode(fields[0], text);
+    check(!fields[0].quoted && text == "\"tail", "\"tail 应按普通字符读取");
+
+    check(reader.next(fields, 4) == 0, "读取结束");
+}
+
+void testImport(int voteCount, unsigned threadCount) {
+    std::istringstream in(legacyTopicsFile(voteCount));
+    vector<VoteTopic> topics;
+    vector<TopicVoteRecord> history;
+    check(FileManager::importTopicsData(topics, history, in, threadCount), "导入旧版话题文件");
+    check(topics.size() == 2, "应导入两个话题");
+    if (topics.size() != 2) {
+        return;
+    }
+    check(topics[0].title == "\"Best\" pick", "话题1标题");
+    check(topics[1].title == "\"open", "话题2标题");
+    check(topics[0].options.size() == 2 && topics[1].options.size() == 2, "每个话题两个选项");
+    check(topics[1].options.size() == 2 && topics[1].options[1].text == "\"d", "话题2选项2文本");
+    check(history.size() == static_cast<size_t>(voteCount) + 1, "投票记录条数");
+    check(!history.empty() && history.back().voterId == "\"x", "最后一条投票记录的投票人ID");
+}
+
+} // namespace
+
+int main() {
+    testReaderFields();
+    testImport(1, 1);
+    testImport(200000, 1);
+    testImport(200000, 4);
+    if (failures != 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("csv_legacy_test: ok\n");
+    return 0;
+}